@@ -0,0 +1,170 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_ALGEBRA_BATCH_INVERT_H_
+#define PRIVACY_PROOFS_ZK_LIB_ALGEBRA_BATCH_INVERT_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace proofs {
+
+// Invert v[0], ..., v[n-1] in place with Montgomery's trick: one field
+// inversion of the product of all elements, and about 3n
+// multiplications to unwind it.  Zero elements are skipped and stay
+// zero.
+//
+// Works for any field with the usual interface (mul(), mulf(),
+// invertf(), one(), zero() and Elt::operator==), e.g. the prime fields
+// and GF2_128, whose multiplication is gf2_128_mul() from gf2k/sysdep.h.
+//
+// A single product chain is bound by the latency of the multiplication,
+// so the elements are dealt round-robin to kLanes independent chains,
+// and only the kLanes chain products are combined before the inversion.
+//
+// The unwinding needs all prefix products.  Once v no longer fits in
+// the last-level cache, streaming v and a prefix array of the same size
+// through memory twice costs more than recomputing: the input is then
+// split into blocks, the block products are inverted with the same trick
+// (recursively), and each block is unwound from its own inverse with a
+// block-sized scratch array that stays in cache.  That takes one more
+// multiplication per element but no O(n) scratch.
+constexpr size_t kBatchInvertFlatBytes = size_t(16) << 20;
+constexpr size_t kBatchInvertBlockBytes = size_t(64) << 10;
+
+namespace batch_invert_internal {
+
+constexpr size_t kLanes = 4;
+
+// prefix[i] = product of the nonzero v[j], j <= i, j = i (mod kLanes);
+// total[l] = product of the whole lane l (one if empty).
+template <class Field>
+void prefix_products(const Field& F, const typename Field::Elt v[], size_t n,
+                     typename Field::Elt prefix[],
+                     typename Field::Elt total[kLanes]) {
+  using Elt = typename Field::Elt;
+  auto step = [&](size_t i, Elt& acc) {
+    if (!(v[i] == F.zero())) {
+      F.mul(acc, v[i]);
+    }
+    prefix[i] = acc;
+  };
+  for (size_t l = 0; l < kLanes; ++l) {
+    total[l] = F.one();
+  }
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      step(i + l, total[l]);
+    }
+  }
+  for (; i < n; ++i) {
+    step(i, total[i % kLanes]);
+  }
+}
+
+// Given inv[l] = total[l]^-1 from prefix_products(), replace every
+// nonzero v[i] by its inverse.
+template <class Field>
+void unwind(const Field& F, typename Field::Elt v[], size_t n,
+            const typename Field::Elt prefix[],
+            typename Field::Elt inv[kLanes]) {
+  using Elt = typename Field::Elt;
+  // inv = (product of lane up to v[i])^-1, so v[i]^-1 is inv times the
+  // product of the lane before v[i].
+  auto step = [&](size_t i, Elt& inv) {
+    if (v[i] == F.zero()) return;
+    Elt vi = v[i];
+    v[i] = (i >= kLanes) ? F.mulf(inv, prefix[i - kLanes]) : inv;
+    F.mul(inv, vi);
+  };
+  size_t i = n;
+  while (i % kLanes != 0) {
+    --i;
+    step(i, inv[i % kLanes]);
+  }
+  while (i > 0) {
+    i -= kLanes;
+    for (size_t l = kLanes; l-- > 0;) {
+      step(i + l, inv[l]);
+    }
+  }
+}
+
+// total[l] <- total[l]^-1 for nonzero total[], with one inversion.
+template <class Field>
+void invert_lanes(const Field& F, typename Field::Elt total[kLanes]) {
+  using Elt = typename Field::Elt;
+  Elt q[kLanes];
+  q[0] = total[0];
+  for (size_t l = 1; l < kLanes; ++l) {
+    q[l] = F.mulf(q[l - 1], total[l]);
+  }
+  Elt inv = F.invertf(q[kLanes - 1]);
+  for (size_t l = kLanes - 1; l > 0; --l) {
+    Elt t = total[l];
+    total[l] = F.mulf(inv, q[l - 1]);
+    F.mul(inv, t);
+  }
+  total[0] = inv;
+}
+
+}  // namespace batch_invert_internal
+
+template <class Field>
+void batch_invert(const Field& F, typename Field::Elt v[], size_t n) {
+  using Elt = typename Field::Elt;
+  namespace bi = batch_invert_internal;
+  constexpr size_t kLanes = bi::kLanes;
+
+  if (n * sizeof(Elt) <= kBatchInvertFlatBytes) {
+    std::vector<Elt> prefix(n);
+    Elt total[kLanes];
+    bi::prefix_products(F, v, n, prefix.data(), total);
+    bi::invert_lanes(F, total);
+    bi::unwind(F, v, n, prefix.data(), total);
+    return;
+  }
+
+  const size_t block = kBatchInvertBlockBytes / sizeof(Elt);
+  const size_t nblocks = (n + block - 1) / block;
+  std::vector<Elt> scratch(block);
+  std::vector<Elt> totals(nblocks * kLanes);
+  for (size_t b = 0; b < nblocks; ++b) {
+    size_t off = b * block;
+    size_t len = (n - off < block) ? n - off : block;
+    bi::prefix_products(F, v + off, len, scratch.data(), &totals[b * kLanes]);
+  }
+
+  // Lane products are never zero.
+  batch_invert(F, totals.data(), totals.size());
+
+  for (size_t b = 0; b < nblocks; ++b) {
+    size_t off = b * block;
+    size_t len = (n - off < block) ? n - off : block;
+    Elt unused[kLanes];
+    bi::prefix_products(F, v + off, len, scratch.data(), unused);
+    bi::unwind(F, v + off, len, scratch.data(), &totals[b * kLanes]);
+  }
+}
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_ALGEBRA_BATCH_INVERT_H_
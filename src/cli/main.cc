@@ -32,9 +32,16 @@
 #include <magic_enum.hpp>
 #include <circuits/mdoc/mdoc_zk.h>
 #include <circuits/mdoc/mdoc_examples.h>
+#include <util/mem_accounting.h>
+#include <util/perf_counters.h>
+#include <util/trace.h>
 
 namespace fs = std::filesystem;
 
+// Marks a profiled phase for --trace, --perf and --mem
+#define CLI_PHASE(name) \
+    PROOFS_TRACE_SCOPE(name); PROOFS_PERF_PHASE(name); PROOFS_MEM_PHASE(name)
+
 // Modern C++17 compatible string formatting
 template<typename... Args>
 std::string format_string(const std::string& format, Args... args) {
@@ -153,7 +160,10 @@ int circuit_gen(const std::string& circuit_file, const std::string& zkspec_str)
         uint8_t* circuit_bytes = nullptr;
         size_t circuit_len = 0;
 
-        auto result = generate_circuit(zk_spec, &circuit_bytes, &circuit_len);
+        auto result = [&] {
+            CLI_PHASE("generate_circuit");
+            return generate_circuit(zk_spec, &circuit_bytes, &circuit_len);
+        }();
 
         if (result != CIRCUIT_GENERATION_SUCCESS) {
             std::cerr << "Circuit generation failed with error: "
@@ -220,6 +230,7 @@ int mdoc_prove(const std::string& circuit_file,
                const std::string& time_str,
                const std::string& doc_type) {
 
+    CLI_PHASE("mdoc_prove");
     std::cout << "Proving mDoc with:\n";
     std::cout << "  Circuit: " << circuit_file << "\n";
     std::cout << "  Proof output: " << proof_file << "\n";
@@ -249,15 +260,18 @@ int mdoc_prove(const std::string& circuit_file,
         attrs[0].value_len = std::min(strlen(attr_value), sizeof(attrs[0].value));
         attrs[0].type = kPrimitive;
 
-        auto result = run_mdoc_prover(
-            circuit.data(), circuit.size(),
-            example.mdoc, example.mdoc_size,
-            example.pkx.as_pointer, example.pky.as_pointer,
-            transcript.data(), transcript.size(),
-            attrs, 1,
-            time_str.c_str(),
-            &proof, &proof_len, zk_spec
-        );
+        auto result = [&] {
+            CLI_PHASE("run_mdoc_prover");
+            return run_mdoc_prover(
+                circuit.data(), circuit.size(),
+                example.mdoc, example.mdoc_size,
+                example.pkx.as_pointer, example.pky.as_pointer,
+                transcript.data(), transcript.size(),
+                attrs, 1,
+                time_str.c_str(),
+                &proof, &proof_len, zk_spec
+            );
+        }();
 
         if (result != MDOC_PROVER_SUCCESS) {
             std::cerr << "Prover failed with error: "
@@ -292,6 +306,7 @@ int mdoc_verify(const std::string& circuit_file,
                 const std::string& time_str,
                 const std::string& doc_type) {
 
+    CLI_PHASE("mdoc_verify");
     std::cout << "Verifying mDoc proof with:\n";
     std::cout << "  Circuit: " << circuit_file << "\n";
     std::cout << "  Proof: " << proof_file << "\n";
@@ -320,15 +335,18 @@ int mdoc_verify(const std::string& circuit_file,
         attrs[0].value_len = std::min(strlen(attr_value), sizeof(attrs[0].value));
         attrs[0].type = kPrimitive;
 
-        auto result = run_mdoc_verifier(
-            circuit.data(), circuit.size(),
-            example.pkx.as_pointer, example.pky.as_pointer,
-            transcript.data(), transcript.size(),
-            attrs, 1,
-            time_str.c_str(),
-            proof.data(), proof.size(), doc_type.c_str(),
-            zk_spec
-        );
+        auto result = [&] {
+            CLI_PHASE("run_mdoc_verifier");
+            return run_mdoc_verifier(
+                circuit.data(), circuit.size(),
+                example.pkx.as_pointer, example.pky.as_pointer,
+                transcript.data(), transcript.size(),
+                attrs, 1,
+                time_str.c_str(),
+                proof.data(), proof.size(), doc_type.c_str(),
+                zk_spec
+            );
+        }();
 
         if (result != MDOC_VERIFIER_SUCCESS) {
             std::cerr << "Verification failed with error: "
@@ -364,6 +382,66 @@ void list_zkspecs() {
     std::cout << "  --zkspec list      # Show this list\n";
 }
 
+// Per-phase hardware counters collected with --perf
+void print_perf_phases() {
+    perf_phase_result phases[32];
+    size_t n = std::min(proofs::perf_phase_results(phases, 32), size_t(32));
+    if (n == 0) {
+        std::cerr << "No phases recorded (perf_event_open unavailable, or no instrumented phase ran)\n";
+        return;
+    }
+    std::cerr << format_string("%-20s %6s %10s %14s %14s %6s %9s %9s %9s\n",
+                               "phase", "calls", "wall ms", "cycles", "instructions",
+                               "IPC", "L1D MPKI", "LLC MPKI", "BR MPKI");
+    for (size_t i = 0; i < n; i++) {
+        const auto& v = phases[i].totals;
+        // Counters that were not opened, or not scheduled for the whole
+        // phase, are shown as n/a rather than as 0 or a partial count
+        const uint32_t core = PERF_COUNTER_CYCLES | PERF_COUNTER_INSTRUCTIONS;
+        const bool rates = (v.valid & core) == core && v.cycles > 0 && v.instructions > 0;
+        auto count = [&](uint32_t bit, uint64_t value) {
+            return (v.valid & bit) ? std::to_string(value) : std::string("n/a");
+        };
+        auto mpki = [&](uint32_t bit, uint64_t misses) {
+            return rates && (v.valid & bit)
+                ? format_string("%.2f", misses / (v.instructions / 1000.0))
+                : std::string("n/a");
+        };
+        std::cerr << format_string("%-20s %6llu %10.3f %14s %14s %6s %9s %9s %9s\n",
+                                   phases[i].name,
+                                   static_cast<unsigned long long>(phases[i].calls),
+                                   v.wall_ns / 1e6,
+                                   count(PERF_COUNTER_CYCLES, v.cycles).c_str(),
+                                   count(PERF_COUNTER_INSTRUCTIONS, v.instructions).c_str(),
+                                   rates ? format_string("%.2f", double(v.instructions) / v.cycles).c_str() : "n/a",
+                                   mpki(PERF_COUNTER_L1D_MISSES, v.l1d_misses).c_str(),
+                                   mpki(PERF_COUNTER_LLC_MISSES, v.llc_misses).c_str(),
+                                   mpki(PERF_COUNTER_BRANCH_MISSES, v.branch_misses).c_str());
+    }
+}
+
+// Per-phase heap usage collected with --mem
+void print_mem_phases() {
+    if (!proofs::mem_accounting_available()) {
+        std::cerr << "Heap accounting not built in; rebuild with -DPROOFS_MEM_ACCOUNTING\n";
+        return;
+    }
+    mem_phase_result phases[32];
+    size_t n = std::min(proofs::mem_phase_results(phases, 32), size_t(32));
+    std::cerr << format_string("%-20s %6s %12s %12s %12s\n",
+                               "phase", "calls", "start MiB", "end MiB", "peak MiB");
+    for (size_t i = 0; i < n; i++) {
+        std::cerr << format_string("%-20s %6llu %12.1f %12.1f %12.1f\n",
+                                   phases[i].name,
+                                   static_cast<unsigned long long>(phases[i].calls),
+                                   phases[i].start_bytes / 1048576.0,
+                                   phases[i].end_bytes / 1048576.0,
+                                   phases[i].peak_bytes / 1048576.0);
+    }
+    std::cerr << format_string("process peak: %.1f MiB\n",
+                               proofs::mem_peak_bytes() / 1048576.0);
+}
+
 int main(int argc, char** argv) {
     CLI::App app{"Longfellow-ZK: Zero-Knowledge Proof CLI for mDoc Verification", "longfellow-zk"};
     app.require_subcommand(1);
@@ -372,6 +450,20 @@ int main(int argc, char** argv) {
     std::string circuit_file, proof_file, public_key_file, transcript_file, time_str, doc_type;
     std::string zkspec_str = "latest"; // Default to latest
 
+    // Global profiling options, accepted before or after the subcommand
+    std::string trace_file;
+    app.fallthrough();
+    app.add_option("--trace", trace_file,
+        "Write a Chrome trace-event JSON (chrome://tracing, Perfetto) of the run")
+        ->each([](const std::string&) { proofs::trace_enable(true); });
+    bool perf = false;
+    app.add_flag("--perf", perf,
+        "Report hardware performance counters (cycles, IPC, cache and branch misses) per phase")
+        ->each([](const std::string&) { proofs::perf_counters_enable(); });
+    bool mem = false;
+    app.add_flag("--mem", mem,
+        "Report heap usage and high-water mark per phase (needs a -DPROOFS_MEM_ACCOUNTING build)");
+
     // Circuit generation command
     auto* circuit_gen_cmd = app.add_subcommand("circuit_gen", "Generate ZK circuit");
 
@@ -442,6 +534,16 @@ int main(int argc, char** argv) {
 
     try {
         app.parse(argc, argv);
+        if (!trace_file.empty() && !proofs::trace_dump_json(trace_file.c_str())) {
+            std::cerr << "Error: cannot write trace file '" << trace_file << "'\n";
+            return 1;
+        }
+        if (perf) {
+            print_perf_phases();
+        }
+        if (mem) {
+            print_mem_phases();
+        }
         return 0;
     } catch (const CLI::ParseError& e) {
         return app.exit(e);
@@ -0,0 +1,72 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_GF2K_CLMUL64_H_
+#define PRIVACY_PROOFS_ZK_LIB_GF2K_CLMUL64_H_
+
+#include <cstdint>
+
+namespace proofs {
+
+// Carry-less multiplication without a carry-less multiply instruction,
+// after Thomas Pornin's BearSSL (ghash_ctmul64.c).  Splitting the
+// operands into four bit classes (bits 0, 1, 2, 3 mod 4) leaves three
+// zero bits between the set bits of each part.  In an integer multiply
+// of two parts, every position below bit 60 collects at most 15
+// products, whose sum fits below the next live position 4 bits up;
+// bits 60 to 63 can collect 16, but those carries land at bit 64 or
+// above, outside the word.  Masking the sums back to their class gives
+// the low 64 bits of the carry-less product with 16 integer multiplies.
+static inline uint64_t bmul64(uint64_t x, uint64_t y) {
+  const uint64_t m0 = 0x1111111111111111ULL;
+  const uint64_t m1 = 0x2222222222222222ULL;
+  const uint64_t m2 = 0x4444444444444444ULL;
+  const uint64_t m3 = 0x8888888888888888ULL;
+  uint64_t x0 = x & m0, x1 = x & m1, x2 = x & m2, x3 = x & m3;
+  uint64_t y0 = y & m0, y1 = y & m1, y2 = y & m2, y3 = y & m3;
+  uint64_t z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+  uint64_t z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+  uint64_t z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+  uint64_t z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+  return (z0 & m0) | (z1 & m1) | (z2 & m2) | (z3 & m3);
+}
+
+// bit reversal of a 64-bit word
+static inline uint64_t rev64(uint64_t x) {
+  x = ((x & 0x5555555555555555ULL) << 1) | ((x >> 1) & 0x5555555555555555ULL);
+  x = ((x & 0x3333333333333333ULL) << 2) | ((x >> 2) & 0x3333333333333333ULL);
+  x = ((x & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+  x = ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+  x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+  return (x << 32) | (x >> 32);
+}
+
+// 64x64->128 carry-less multiply.  The product of the bit-reversed
+// operands is the bit-reversed product, so its low half yields the
+// high half of the result (shifted by one, since the product has 127
+// bits).
+static inline void clmul64(uint64_t a, uint64_t b, uint64_t* hi, uint64_t* lo) {
+  *lo = bmul64(a, b);
+  *hi = rev64(bmul64(rev64(a), rev64(b))) >> 1;
+}
+
+}  // namespace proofs
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_GF2K_CLMUL64_H_
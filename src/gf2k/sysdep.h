@@ -53,6 +53,15 @@
 #if defined(__x86_64__) || defined(__i386__)
 #include <immintrin.h>  // IWYU pragma: keep
 
+#include "gf2k/clmul64.h"
+#include "util/cpu_features.h"
+
+// 256- and 512-bit carry-less multiply (Ice Lake, Zen 3 and later) for
+// the array kernels below.  Selected at runtime.
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 8)
+#define GF2K_HAVE_VPCLMUL 1
+#endif
+
 namespace proofs {
 
 using gf2_128_elt_t = __m128i;
@@ -74,22 +83,74 @@ static inline gf2_128_elt_t gf2_128_add(gf2_128_elt_t x, gf2_128_elt_t y) {
   return _mm_xor_si128(x, y);
 }
 
+// _mm_clmulepi64_si128(x, y, imm).
+//
+// Builds with -mpclmul (or an -march that implies it) use the intrinsic
+// unconditionally.  Other builds must still run on CPUs without
+// PCLMULQDQ, so they test gf2_128_have_pclmul and otherwise fall back
+// to the portable multiply in clmul64.h.  The instruction is then
+// emitted with inline asm rather than from a target("pclmul") function,
+// because the latter could not be inlined into callers compiled without
+// the flag, and a call per product would cost more than the product.
+// The flag is a constant after startup, so the compiler can test it
+// once per multiply (or hoist it out of a loop).  Until it is set by
+// the static initializer it reads false, which is slow but correct.
+#if !defined(__PCLMUL__)
+inline const bool gf2_128_have_pclmul = cpu_has(CPU_FEATURE_PCLMUL);
+
+// Out of line, so that the fallback does not take registers from the
+// loops that inline the fast path.
+__attribute__((noinline, cold)) static inline gf2_128_elt_t
+gf2_128_clmul_soft(uint64_t a, uint64_t b) {
+  uint64_t hi, lo;
+  clmul64(a, b, &hi, &lo);
+  return gf2_128_of_uint64x2(std::array<uint64_t, 2>{lo, hi});
+}
+#endif
+
+template <int imm>
+static inline gf2_128_elt_t gf2_128_clmul(gf2_128_elt_t x, gf2_128_elt_t y) {
+#if defined(__PCLMUL__)
+  return _mm_clmulepi64_si128(x, y, imm);
+#else
+  if (gf2_128_have_pclmul) {
+    gf2_128_elt_t r;
+#if defined(__AVX__)
+    __asm__("vpclmulqdq %3, %2, %1, %0" : "=x"(r) : "x"(x), "x"(y), "i"(imm));
+#else
+    r = x;
+    __asm__("pclmulqdq %2, %1, %0" : "+x"(r) : "x"(y), "i"(imm));
+#endif
+    return r;
+  }
+  return gf2_128_clmul_soft(static_cast<uint64_t>(x[imm & 1]),
+                            static_cast<uint64_t>(y[(imm >> 4) & 1]));
+#endif
+}
+
 // return t0 + x^64 * t1
 static inline gf2_128_elt_t gf2_128_reduce(gf2_128_elt_t t0, gf2_128_elt_t t1) {
   const gf2_128_elt_t poly = {0x87};
   t0 = _mm_xor_si128(t0, _mm_slli_si128(t1, 64 /*bits*/ / 8 /*bits/byte*/));
-  t0 = _mm_xor_si128(t0, _mm_clmulepi64_si128(t1, poly, 0x01));
+  t0 = _mm_xor_si128(t0, gf2_128_clmul<0x01>(t1, poly));
   return t0;
 }
-static inline gf2_128_elt_t gf2_128_mul(gf2_128_elt_t x, gf2_128_elt_t y) {
-  gf2_128_elt_t t1a = _mm_clmulepi64_si128(x, y, 0x01);
-  gf2_128_elt_t t1b = _mm_clmulepi64_si128(x, y, 0x10);
-  gf2_128_elt_t t1 = gf2_128_add(t1a, t1b);
-  gf2_128_elt_t t2 = _mm_clmulepi64_si128(x, y, 0x11);
-  t1 = gf2_128_reduce(t1, t2);
-  gf2_128_elt_t t0 = _mm_clmulepi64_si128(x, y, 0x00);
-  t0 = gf2_128_reduce(t0, t1);
-  return t0;
+
+// 64x64 carry-less products of the low halves, of the high halves,
+// and of the sums of the two halves (the three Karatsuba terms).
+static inline gf2_128_elt_t gf2_128_clmul_lo(gf2_128_elt_t x,
+                                             gf2_128_elt_t y) {
+  return gf2_128_clmul<0x00>(x, y);
+}
+static inline gf2_128_elt_t gf2_128_clmul_hi(gf2_128_elt_t x,
+                                             gf2_128_elt_t y) {
+  return gf2_128_clmul<0x11>(x, y);
+}
+static inline gf2_128_elt_t gf2_128_clmul_mid(gf2_128_elt_t x,
+                                              gf2_128_elt_t y) {
+  x = _mm_xor_si128(x, _mm_shuffle_epi32(x, 0x4E));
+  y = _mm_xor_si128(y, _mm_shuffle_epi32(y, 0x4E));
+  return gf2_128_clmul<0x00>(x, y);
 }
 }  // namespace proofs
 #elif defined(__aarch64__)
@@ -136,16 +197,19 @@ static inline gf2_128_elt_t gf2_128_reduce(gf2_128_elt_t t0, gf2_128_elt_t t1) {
 static inline gf2_128_elt_t gf2_128_add(gf2_128_elt_t x, gf2_128_elt_t y) {
   return vaddq_p64(x, y);
 }
-static inline gf2_128_elt_t gf2_128_mul(gf2_128_elt_t x, gf2_128_elt_t y) {
-  gf2_128_elt_t swx = vextq_p64(x, x, 1);
-  gf2_128_elt_t t1a = vmull_high(swx, y);
-  gf2_128_elt_t t1b = vmull_low(swx, y);
-  gf2_128_elt_t t1 = vaddq_p64(t1a, t1b);
-  gf2_128_elt_t t2 = vmull_high(x, y);
-  t1 = gf2_128_reduce(t1, t2);
-  gf2_128_elt_t t0 = vmull_low(x, y);
-  t0 = gf2_128_reduce(t0, t1);
-  return t0;
+static inline gf2_128_elt_t gf2_128_clmul_lo(gf2_128_elt_t x,
+                                             gf2_128_elt_t y) {
+  return vmull_low(x, y);
+}
+static inline gf2_128_elt_t gf2_128_clmul_hi(gf2_128_elt_t x,
+                                             gf2_128_elt_t y) {
+  return vmull_high(x, y);
+}
+static inline gf2_128_elt_t gf2_128_clmul_mid(gf2_128_elt_t x,
+                                              gf2_128_elt_t y) {
+  x = vaddq_p64(x, vextq_p64(x, x, 1));
+  y = vaddq_p64(y, vextq_p64(y, y, 1));
+  return vmull_low(x, y);
 }
 }  // namespace proofs
 
@@ -173,20 +237,59 @@ static inline gf2_128_elt_t gf2_128_add(gf2_128_elt_t x, gf2_128_elt_t y) {
   // return vreinterpretq_p64_u64(veorq_u64(ux, uy));
 }
 
-// Emulate vmull_p64() with vmull_p8().
-//
-// This emulation is pretty naive and it performs a lot of permutations.
-//
-// A possibly better alternative appears in Danilo Câmara, Conrado
+// Emulate vmull_p64() with vmull_p8(), after Danilo Câmara, Conrado
 // Gouvêa, Julio López, Ricardo Dahab, "Fast Software Polynomial
-// Multiplication on ARM Processors Using the NEON Engine", 1st
-// Cross-Domain Conference and Workshop on Availability, Reliability,
-// and Security in Information Systems (CD-ARES), Sep 2013,
-// Regensburg, Germany. pp.137-154. ⟨hal-01506572⟩
+// Multiplication on ARM Processors Using the NEON Engine", CD-ARES
+// 2013 (hal-01506572), in the form used by __pmull_p8 in Linux's
+// arch/arm/crypto/ghash-ce-core.S.
 //
-// However, the code from that paper makes heavy use of type
-// punning of 128-bit registers as two 64-bit registers, which
-// I don't know how to express in C.
+// With a = sum a_i X^i and b = sum b_j X^j over bytes (X = x^8), one
+// vmull_p8 of a and b rotated by k bytes yields, in 16-bit lane i, the
+// product a_i b_{i+k}, whose place in a*b is X^(2i+k).  Pairing the
+// rotations of a and of b covers all byte distances k and 8 - k with
+// eight vmull_p8 in total (d to k below).  Each such product lies at its
+// lane position shifted by k bytes, except for the k lanes that wrapped
+// around, which belong 64 bits lower; pmull_fold() moves them there
+// before the shift.
+//
+// That is 37 NEON ops and no vuzp, against 48 ops with eight vuzp.8 for
+// the byte-serial multiply it replaces.  The 2x target for this path is
+// unverified: it has not been measured on ARMv7 hardware.
+static inline uint64x2_t pmull_fold(uint64x2_t t, uint64_t keep) {
+  uint64x1_t lo = vget_low_u64(t);
+  uint64x1_t hi = vget_high_u64(t);
+  lo = veor_u64(lo, hi);
+  hi = vand_u64(hi, vcreate_u64(keep));
+  lo = veor_u64(lo, hi);
+  return vcombine_u64(lo, hi);
+}
+
+static inline uint64x2_t pmul64x64(poly8x8_t a, poly8x8_t b) {
+  uint64x2_t d = vreinterpretq_u64_p16(vmull_p8(a, b));
+  uint64x2_t e = vreinterpretq_u64_p16(vmull_p8(a, vext_p8(b, b, 1)));
+  uint64x2_t f = vreinterpretq_u64_p16(vmull_p8(vext_p8(a, a, 1), b));
+  uint64x2_t g = vreinterpretq_u64_p16(vmull_p8(a, vext_p8(b, b, 2)));
+  uint64x2_t h = vreinterpretq_u64_p16(vmull_p8(vext_p8(a, a, 2), b));
+  uint64x2_t i = vreinterpretq_u64_p16(vmull_p8(a, vext_p8(b, b, 3)));
+  uint64x2_t j = vreinterpretq_u64_p16(vmull_p8(vext_p8(a, a, 3), b));
+  uint64x2_t k = vreinterpretq_u64_p16(vmull_p8(a, vext_p8(b, b, 4)));
+
+  // distances 1 and 7, 2 and 6, 3 and 5, and 4
+  uint64x2_t t0 = pmull_fold(veorq_u64(e, f), 0x0000ffffffffffffULL);
+  uint64x2_t t1 = pmull_fold(veorq_u64(g, h), 0x00000000ffffffffULL);
+  uint64x2_t t2 = pmull_fold(veorq_u64(i, j), 0x000000000000ffffULL);
+  uint64x2_t t3 = pmull_fold(k, 0);
+
+  uint8x16_t r0 = vreinterpretq_u8_u64(t0);
+  uint8x16_t r1 = vreinterpretq_u8_u64(t1);
+  uint8x16_t r2 = vreinterpretq_u8_u64(t2);
+  uint8x16_t r3 = vreinterpretq_u8_u64(t3);
+  r0 = veorq_u8(vextq_u8(r0, r0, 15), vextq_u8(r1, r1, 14));
+  r2 = veorq_u8(vextq_u8(r2, r2, 13), vextq_u8(r3, r3, 12));
+  return veorq_u64(d, vreinterpretq_u64_u8(veorq_u8(r0, r2)));
+}
+
+// 64x8 carry-less multiply, used by the reduction
 static inline poly8x16_t pmul64x8(poly8x8_t x, poly8_t y) {
   const poly8x16_t zero{};
   poly16x8_t wide = vmull_p8(x, vdup_n_p8(y));
@@ -197,78 +300,13 @@ static inline poly8x16_t pmul64x8(poly8x8_t x, poly8_t y) {
   return vreinterpretq_p8_u8(veorq_u8(lhs, rhs));
 }
 
-// multiply/add.  Return (cout, s) = cin + x * y where the final sum
-// would be (cout << 8) + s.
-static inline poly8x16x2_t pmac64x8(poly8x16_t cin, poly8x8_t x, poly8_t y) {
-  const poly8x16_t zero{};
-  poly16x8_t wide = vmull_p8(x, vdup_n_p8(y));
-  poly8x16_t prod = vreinterpretq_p8_p16(wide);
-  poly8x16x2_t uzp = vuzpq_p8(prod, zero);
-  uint8x16_t lhs = vreinterpretq_u8_p8(uzp.val[0]);
-  uint8x16_t rhs = vreinterpretq_u8_p8(cin);
-  uzp.val[0] = vreinterpretq_p8_u8(veorq_u8(lhs, rhs));
-  return uzp;
-}
-
-static inline poly8x16_t pmul64x64(poly8x8_t x, poly8x8_t y) {
-  poly8x16_t r{};
-
-  poly8x16x2_t prod = pmac64x8(r, x, y[0]);
-  r = prod.val[0];
-  uint8x16_t ur = vreinterpretq_u8_p8(r);
-
-  prod = pmac64x8(prod.val[1], x, y[1]);
-  uint8x16_t rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 15));
-  ur = veorq_u8(ur, rhs);
-
-  prod = pmac64x8(prod.val[1], x, y[2]);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 14));
-  ur = veorq_u8(ur, rhs);
-
-  prod = pmac64x8(prod.val[1], x, y[3]);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 13));
-  ur = veorq_u8(ur, rhs);
-
-  prod = pmac64x8(prod.val[1], x, y[4]);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 12));
-  ur = veorq_u8(ur, rhs);
-
-  prod = pmac64x8(prod.val[1], x, y[5]);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 11));
-  ur = veorq_u8(ur, rhs);
-
-  prod = pmac64x8(prod.val[1], x, y[6]);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 10));
-  ur = veorq_u8(ur, rhs);
-
-  prod = pmac64x8(prod.val[1], x, y[7]);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[0], prod.val[0], 9));
-  ur = veorq_u8(ur, rhs);
-  rhs = vreinterpretq_u8_p8(vextq_p8(prod.val[1], prod.val[1], 8));
-  ur = veorq_u8(ur, rhs);
-
-  return vreinterpretq_p8_u8(ur);
-}
-
 static inline gf2_128_elt_t vmull_low(gf2_128_elt_t t0, gf2_128_elt_t t1) {
-  // vreinterpretq_p64_p8() seems not to be defined, use
-  // static_cast<poly64x2_t>
-  poly8x16_t t0_bytes = vreinterpretq_p8_u64(t0);
-  poly8x16_t t1_bytes = vreinterpretq_p8_u64(t1);
-  poly8x8_t t0_low  = vget_low_p8(t0_bytes);
-  poly8x8_t t1_low  = vget_low_p8(t1_bytes);
-  poly8x16_t low_prod = pmul64x64(t0_low, t1_low);
-  return vreinterpretq_u64_p8(low_prod);
-  // return static_cast<poly64x2_t>(pmul64x64(t0_low, t1_low));
+  return pmul64x64(vreinterpret_p8_u64(vget_low_u64(t0)),
+                   vreinterpret_p8_u64(vget_low_u64(t1)));
 }
 static inline gf2_128_elt_t vmull_high(gf2_128_elt_t t0, gf2_128_elt_t t1) {
-  poly8x16_t t0_bytes = vreinterpretq_p8_u64(t0);
-  poly8x16_t t1_bytes = vreinterpretq_p8_u64(t1);
-  poly8x8_t t0_high = vget_high_p8(t0_bytes);
-  poly8x8_t t1_high = vget_high_p8(t1_bytes);
-  poly8x16_t high_prod = pmul64x64(t0_high, t1_high);
-  return vreinterpretq_u64_p8(high_prod);
-  // return static_cast<poly64x2_t>(pmul64x64(vget_high_p8(t0), vget_high_p8(t1)));
+  return pmul64x64(vreinterpret_p8_u64(vget_high_u64(t0)),
+                   vreinterpret_p8_u64(vget_high_u64(t1)));
 }
 
 // vextq_p64() seems not to be defined.
@@ -288,26 +326,28 @@ static inline gf2_128_elt_t gf2_128_reduce(gf2_128_elt_t t0, gf2_128_elt_t t1) {
   uint8x16_t t1_ext_bytes = vextq_u8(vreinterpretq_u8_u64(zero), t1_bytes, 8);
   t0_bytes = veorq_u8(t0_bytes, t1_ext_bytes);
 
-  uint8x8_t t1_high = vget_high_u8(t1_bytes);
-  uint8x8_t poly_vec = vdup_n_u8(poly);
-  uint16x8_t wide = vmull_u8(t1_high, poly_vec);
-  uint8x16_t prod = vreinterpretq_u8_u16(wide);
+  // The high half of t1 lands at x^128 and folds back as a 64x8
+  // carry-less product with x^7 + x^2 + x + 1.
+  poly8x8_t t1_high = vget_high_p8(vreinterpretq_p8_u64(t1));
+  uint8x16_t prod = vreinterpretq_u8_p8(pmul64x8(t1_high, poly));
   t0_bytes = veorq_u8(t0_bytes, prod);
 
-  // t0 = static_cast<poly64x2_t>(veorq_u8(static_cast<poly8x16_t>(t0), prod));
   return vreinterpretq_u64_u8(t0_bytes);
 }
 
-static inline gf2_128_elt_t gf2_128_mul(gf2_128_elt_t x, gf2_128_elt_t y) {
-  gf2_128_elt_t swx = vextq_p64_1_emul(x, x);
-  gf2_128_elt_t t1a = vmull_high(swx, y);
-  gf2_128_elt_t t1b = vmull_low(swx, y);
-  gf2_128_elt_t t1 = veorq_u64(t1a, t1b);
-  gf2_128_elt_t t2 = vmull_high(x, y);
-  t1 = gf2_128_reduce(t1, t2);
-  gf2_128_elt_t t0 = vmull_low(x, y);
-  t0 = gf2_128_reduce(t0, t1);
-  return t0;
+static inline gf2_128_elt_t gf2_128_clmul_lo(gf2_128_elt_t x,
+                                             gf2_128_elt_t y) {
+  return vmull_low(x, y);
+}
+static inline gf2_128_elt_t gf2_128_clmul_hi(gf2_128_elt_t x,
+                                             gf2_128_elt_t y) {
+  return vmull_high(x, y);
+}
+static inline gf2_128_elt_t gf2_128_clmul_mid(gf2_128_elt_t x,
+                                              gf2_128_elt_t y) {
+  x = veorq_u64(x, vextq_p64_1_emul(x, x));
+  y = veorq_u64(y, vextq_p64_1_emul(y, y));
+  return vmull_low(x, y);
 }
 
 }  // namespace proofs
@@ -320,4 +360,327 @@ static inline gf2_128_elt_t gf2_128_mul(gf2_128_elt_t x, gf2_128_elt_t y) {
 #error "unimplemented gf2k/sysdep.h"
 #endif
 
+namespace proofs {
+
+// Karatsuba multiplication.  With X = x^64, x = x0 + X x1, y = y0 + X y1
+// and lo = x0 y0, hi = x1 y1, mid = (x0 + x1) (y0 + y1):
+//
+//   x * y = lo + X (mid + lo + hi) + X^2 hi
+//
+// which needs three 64x64 carry-less products instead of four.
+static inline gf2_128_elt_t gf2_128_mul(gf2_128_elt_t x, gf2_128_elt_t y) {
+  gf2_128_elt_t lo = gf2_128_clmul_lo(x, y);
+  gf2_128_elt_t hi = gf2_128_clmul_hi(x, y);
+  gf2_128_elt_t mid = gf2_128_clmul_mid(x, y);
+  mid = gf2_128_add(mid, gf2_128_add(lo, hi));
+  return gf2_128_reduce(lo, gf2_128_reduce(mid, hi));
+}
+
+// Unreduced sum of products.  The three Karatsuba terms are bilinear,
+// so a sum of products can accumulate lo, mid and hi separately and
+// pay for the middle-term fixup and the reduction once per sum rather
+// than once per term:
+//
+//   gf2_128_acc_t acc = gf2_128_acc_zero();
+//   for (size_t i = 0; i < n; ++i) acc = gf2_128_mul_acc(acc, x[i], y[i]);
+//   gf2_128_elt_t dot = gf2_128_reduce_acc(acc);
+struct gf2_128_acc_t {
+  gf2_128_elt_t lo, mid, hi;
+};
+
+static inline gf2_128_acc_t gf2_128_acc_zero() {
+  const gf2_128_elt_t zero = gf2_128_of_uint64x2(std::array<uint64_t, 2>{0, 0});
+  return gf2_128_acc_t{zero, zero, zero};
+}
+
+// return acc + x * y, unreduced
+static inline gf2_128_acc_t gf2_128_mul_acc(gf2_128_acc_t acc, gf2_128_elt_t x,
+                                            gf2_128_elt_t y) {
+  acc.lo = gf2_128_add(acc.lo, gf2_128_clmul_lo(x, y));
+  acc.mid = gf2_128_add(acc.mid, gf2_128_clmul_mid(x, y));
+  acc.hi = gf2_128_add(acc.hi, gf2_128_clmul_hi(x, y));
+  return acc;
+}
+
+static inline gf2_128_elt_t gf2_128_reduce_acc(const gf2_128_acc_t &acc) {
+  gf2_128_elt_t mid = gf2_128_add(acc.mid, gf2_128_add(acc.lo, acc.hi));
+  return gf2_128_reduce(acc.lo, gf2_128_reduce(mid, acc.hi));
+}
+
+static inline gf2_128_elt_t gf2_128_sqr(gf2_128_elt_t x) {
+  // The middle Karatsuba term of x * x is 2 x0 x1 = 0.
+  const gf2_128_elt_t zero = gf2_128_of_uint64x2(std::array<uint64_t, 2>{0, 0});
+  gf2_128_elt_t lo = gf2_128_clmul_lo(x, x);
+  gf2_128_elt_t hi = gf2_128_clmul_hi(x, x);
+  return gf2_128_reduce(lo, gf2_128_reduce(zero, hi));
+}
+
+// Multiplicative inverse, x^-1 = x^(2^128 - 2) = (x^(2^127 - 1))^2, by
+// Itoh-Tsujii.  With b_k = x^(2^k - 1) we have b_2k = b_k^(2^k) b_k and
+// b_(k+1) = b_k^2 x, and the chain 1, 2, 3, 6, 7, ..., 126, 127 reaches
+// b_127 in 126 squarings and 12 multiplications.  Returns 0 for x = 0.
+static inline gf2_128_elt_t gf2_128_inv(gf2_128_elt_t x) {
+  gf2_128_elt_t b = x;
+  for (int k = 1; k < 127; k = 2 * k + 1) {
+    gf2_128_elt_t t = b;
+    for (int i = 0; i < k; ++i) t = gf2_128_sqr(t);
+    b = gf2_128_mul(t, b);
+    b = gf2_128_mul(gf2_128_sqr(b), x);
+  }
+  return gf2_128_sqr(b);
+}
+
+#if defined(GF2K_HAVE_VPCLMUL)
+// Two (AVX2) or four (AVX-512) independent elements per register, one
+// per 128-bit lane.  Same Karatsuba and reduction steps as the scalar
+// code; VPCLMULQDQ applies the immediate to every lane.
+#define GF2K_TARGET_X2 __attribute__((target("avx2,vpclmulqdq")))
+#define GF2K_TARGET_X4 __attribute__((target("avx512f,vpclmulqdq")))
+
+GF2K_TARGET_X2 static inline __m256i gf2_128_reduce_x2(__m256i t0,
+                                                       __m256i t1) {
+  const __m256i poly = _mm256_set_epi64x(0, 0x87, 0, 0x87);
+  t0 = _mm256_xor_si256(t0, _mm256_bslli_epi128(t1, 8));
+  return _mm256_xor_si256(t0, _mm256_clmulepi64_epi128(t1, poly, 0x01));
+}
+
+GF2K_TARGET_X2 static inline __m256i gf2_128_mul_x2(__m256i x, __m256i y) {
+  __m256i lo = _mm256_clmulepi64_epi128(x, y, 0x00);
+  __m256i hi = _mm256_clmulepi64_epi128(x, y, 0x11);
+  __m256i xs = _mm256_xor_si256(x, _mm256_shuffle_epi32(x, 0x4E));
+  __m256i ys = _mm256_xor_si256(y, _mm256_shuffle_epi32(y, 0x4E));
+  __m256i mid = _mm256_clmulepi64_epi128(xs, ys, 0x00);
+  mid = _mm256_xor_si256(mid, _mm256_xor_si256(lo, hi));
+  return gf2_128_reduce_x2(lo, gf2_128_reduce_x2(mid, hi));
+}
+
+GF2K_TARGET_X4 static inline __m512i gf2_128_reduce_x4(__m512i t0,
+                                                       __m512i t1) {
+  const __m512i poly = _mm512_set_epi64(0, 0x87, 0, 0x87, 0, 0x87, 0, 0x87);
+  // unpacklo(0, t1) == bslli(t1, 8) per lane, without needing AVX512BW
+  t0 = _mm512_xor_si512(t0,
+                        _mm512_unpacklo_epi64(_mm512_setzero_si512(), t1));
+  return _mm512_xor_si512(t0, _mm512_clmulepi64_epi128(t1, poly, 0x01));
+}
+
+GF2K_TARGET_X4 static inline __m512i gf2_128_mul_x4(__m512i x, __m512i y) {
+  __m512i lo = _mm512_clmulepi64_epi128(x, y, 0x00);
+  __m512i hi = _mm512_clmulepi64_epi128(x, y, 0x11);
+  __m512i xs = _mm512_xor_si512(x, _mm512_shuffle_epi32(x, _MM_PERM_BADC));
+  __m512i ys = _mm512_xor_si512(y, _mm512_shuffle_epi32(y, _MM_PERM_BADC));
+  __m512i mid = _mm512_clmulepi64_epi128(xs, ys, 0x00);
+  mid = _mm512_xor_si512(mid, _mm512_xor_si512(lo, hi));
+  return gf2_128_reduce_x4(lo, gf2_128_reduce_x4(mid, hi));
+}
+
+// Array kernels.  Each handles the largest multiple of the vector
+// width and returns the number of elements done; the caller finishes
+// the tail with the scalar code.
+GF2K_TARGET_X2 static inline size_t gf2_128_mul_array_x2(
+    size_t n, gf2_128_elt_t z[], const gf2_128_elt_t x[],
+    const gf2_128_elt_t y[]) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&x[i]));
+    __m256i yv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&y[i]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&z[i]),
+                        gf2_128_mul_x2(xv, yv));
+  }
+  return i;
+}
+
+GF2K_TARGET_X4 static inline size_t gf2_128_mul_array_x4(
+    size_t n, gf2_128_elt_t z[], const gf2_128_elt_t x[],
+    const gf2_128_elt_t y[]) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m512i xv = _mm512_loadu_si512(&x[i]);
+    __m512i yv = _mm512_loadu_si512(&y[i]);
+    _mm512_storeu_si512(&z[i], gf2_128_mul_x4(xv, yv));
+  }
+  return i;
+}
+
+// y[i] += a * x[i]
+GF2K_TARGET_X2 static inline size_t gf2_128_axpy_array_x2(
+    size_t n, gf2_128_elt_t y[], gf2_128_elt_t a, const gf2_128_elt_t x[]) {
+  const __m256i av = _mm256_broadcastsi128_si256(a);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m256i *yp = reinterpret_cast<__m256i *>(&y[i]);
+    __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&x[i]));
+    _mm256_storeu_si256(
+        yp, _mm256_xor_si256(_mm256_loadu_si256(yp), gf2_128_mul_x2(av, xv)));
+  }
+  return i;
+}
+
+GF2K_TARGET_X4 static inline size_t gf2_128_axpy_array_x4(
+    size_t n, gf2_128_elt_t y[], gf2_128_elt_t a, const gf2_128_elt_t x[]) {
+  const __m512i av = _mm512_broadcast_i32x4(a);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m512i xv = _mm512_loadu_si512(&x[i]);
+    __m512i yv = _mm512_loadu_si512(&y[i]);
+    _mm512_storeu_si512(&y[i], _mm512_xor_si512(yv, gf2_128_mul_x4(av, xv)));
+  }
+  return i;
+}
+
+// x[i] *= a
+GF2K_TARGET_X2 static inline size_t gf2_128_scale_array_x2(
+    size_t n, gf2_128_elt_t x[], gf2_128_elt_t a) {
+  const __m256i av = _mm256_broadcastsi128_si256(a);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m256i *xp = reinterpret_cast<__m256i *>(&x[i]);
+    _mm256_storeu_si256(xp, gf2_128_mul_x2(av, _mm256_loadu_si256(xp)));
+  }
+  return i;
+}
+
+GF2K_TARGET_X4 static inline size_t gf2_128_scale_array_x4(
+    size_t n, gf2_128_elt_t x[], gf2_128_elt_t a) {
+  const __m512i av = _mm512_broadcast_i32x4(a);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm512_storeu_si512(&x[i], gf2_128_mul_x4(av, _mm512_loadu_si512(&x[i])));
+  }
+  return i;
+}
+
+// *acc += sum_i x[i] * y[i].  The lanes accumulate unreduced Karatsuba
+// terms, exactly like gf2_128_mul_acc(), and are folded into *acc at
+// the end.
+GF2K_TARGET_X2 static inline size_t gf2_128_dot_array_x2(
+    size_t n, gf2_128_acc_t *acc, const gf2_128_elt_t x[],
+    const gf2_128_elt_t y[]) {
+  __m256i lo = _mm256_setzero_si256();
+  __m256i mid = _mm256_setzero_si256();
+  __m256i hi = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&x[i]));
+    __m256i yv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&y[i]));
+    __m256i xs = _mm256_xor_si256(xv, _mm256_shuffle_epi32(xv, 0x4E));
+    __m256i ys = _mm256_xor_si256(yv, _mm256_shuffle_epi32(yv, 0x4E));
+    lo = _mm256_xor_si256(lo, _mm256_clmulepi64_epi128(xv, yv, 0x00));
+    hi = _mm256_xor_si256(hi, _mm256_clmulepi64_epi128(xv, yv, 0x11));
+    mid = _mm256_xor_si256(mid, _mm256_clmulepi64_epi128(xs, ys, 0x00));
+  }
+  acc->lo = _mm_xor_si128(acc->lo, _mm_xor_si128(_mm256_castsi256_si128(lo),
+                                       _mm256_extracti128_si256(lo, 1)));
+  acc->mid = _mm_xor_si128(acc->mid, _mm_xor_si128(_mm256_castsi256_si128(mid),
+                                         _mm256_extracti128_si256(mid, 1)));
+  acc->hi = _mm_xor_si128(acc->hi, _mm_xor_si128(_mm256_castsi256_si128(hi),
+                                       _mm256_extracti128_si256(hi, 1)));
+  return i;
+}
+
+GF2K_TARGET_X4 static inline __m128i gf2_128_xor_lanes_x4(__m512i v) {
+  __m256i h = _mm256_xor_si256(_mm512_castsi512_si256(v),
+                               _mm512_extracti64x4_epi64(v, 1));
+  return _mm_xor_si128(_mm256_castsi256_si128(h),
+                       _mm256_extracti128_si256(h, 1));
+}
+
+GF2K_TARGET_X4 static inline size_t gf2_128_dot_array_x4(
+    size_t n, gf2_128_acc_t *acc, const gf2_128_elt_t x[],
+    const gf2_128_elt_t y[]) {
+  __m512i lo = _mm512_setzero_si512();
+  __m512i mid = _mm512_setzero_si512();
+  __m512i hi = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m512i xv = _mm512_loadu_si512(&x[i]);
+    __m512i yv = _mm512_loadu_si512(&y[i]);
+    __m512i xs = _mm512_xor_si512(xv, _mm512_shuffle_epi32(xv, _MM_PERM_BADC));
+    __m512i ys = _mm512_xor_si512(yv, _mm512_shuffle_epi32(yv, _MM_PERM_BADC));
+    lo = _mm512_xor_si512(lo, _mm512_clmulepi64_epi128(xv, yv, 0x00));
+    hi = _mm512_xor_si512(hi, _mm512_clmulepi64_epi128(xv, yv, 0x11));
+    mid = _mm512_xor_si512(mid, _mm512_clmulepi64_epi128(xs, ys, 0x00));
+  }
+  acc->lo = _mm_xor_si128(acc->lo, gf2_128_xor_lanes_x4(lo));
+  acc->mid = _mm_xor_si128(acc->mid, gf2_128_xor_lanes_x4(mid));
+  acc->hi = _mm_xor_si128(acc->hi, gf2_128_xor_lanes_x4(hi));
+  return i;
+}
+
+#undef GF2K_TARGET_X2
+#undef GF2K_TARGET_X4
+#endif  // GF2K_HAVE_VPCLMUL
+
+// Number of elements the array helpers below process per multiply:
+// 4 with AVX-512 and VPCLMULQDQ, 2 with AVX2 and VPCLMULQDQ, else 1.
+static inline int gf2_128_array_width() {
+#if defined(GF2K_HAVE_VPCLMUL)
+  static const int width =
+      cpu_has(CPU_FEATURE_AVX512F | CPU_FEATURE_VPCLMUL)  ? 4
+      : cpu_has(CPU_FEATURE_AVX2 | CPU_FEATURE_VPCLMUL) ? 2
+                                                          : 1;
+  return width;
+#else
+  return 1;
+#endif
+}
+
+// z[i] = x[i] * y[i] for 0 <= i < n.  z may alias x or y.
+static inline void gf2_128_mul_array(size_t n, gf2_128_elt_t z[],
+                                     const gf2_128_elt_t x[],
+                                     const gf2_128_elt_t y[]) {
+  size_t i = 0;
+#if defined(GF2K_HAVE_VPCLMUL)
+  switch (gf2_128_array_width()) {
+    case 4: i = gf2_128_mul_array_x4(n, z, x, y); break;
+    case 2: i = gf2_128_mul_array_x2(n, z, x, y); break;
+  }
+#endif
+  for (; i < n; ++i) z[i] = gf2_128_mul(x[i], y[i]);
+}
+
+// y[i] += a * x[i] for 0 <= i < n
+static inline void gf2_128_axpy_array(size_t n, gf2_128_elt_t y[],
+                                      gf2_128_elt_t a,
+                                      const gf2_128_elt_t x[]) {
+  size_t i = 0;
+#if defined(GF2K_HAVE_VPCLMUL)
+  switch (gf2_128_array_width()) {
+    case 4: i = gf2_128_axpy_array_x4(n, y, a, x); break;
+    case 2: i = gf2_128_axpy_array_x2(n, y, a, x); break;
+  }
+#endif
+  for (; i < n; ++i) y[i] = gf2_128_add(y[i], gf2_128_mul(a, x[i]));
+}
+
+// x[i] *= a for 0 <= i < n
+static inline void gf2_128_scale_array(size_t n, gf2_128_elt_t x[],
+                                       gf2_128_elt_t a) {
+  size_t i = 0;
+#if defined(GF2K_HAVE_VPCLMUL)
+  switch (gf2_128_array_width()) {
+    case 4: i = gf2_128_scale_array_x4(n, x, a); break;
+    case 2: i = gf2_128_scale_array_x2(n, x, a); break;
+  }
+#endif
+  for (; i < n; ++i) x[i] = gf2_128_mul(a, x[i]);
+}
+
+// return sum_i x[i] * y[i], reduced once
+static inline gf2_128_elt_t gf2_128_dot_array(size_t n,
+                                              const gf2_128_elt_t x[],
+                                              const gf2_128_elt_t y[]) {
+  gf2_128_acc_t acc = gf2_128_acc_zero();
+  size_t i = 0;
+#if defined(GF2K_HAVE_VPCLMUL)
+  switch (gf2_128_array_width()) {
+    case 4: i = gf2_128_dot_array_x4(n, &acc, x, y); break;
+    case 2: i = gf2_128_dot_array_x2(n, &acc, x, y); break;
+  }
+#endif
+  for (; i < n; ++i) acc = gf2_128_mul_acc(acc, x[i], y[i]);
+  return gf2_128_reduce_acc(acc);
+}
+
+}  // namespace proofs
+
 #endif  // PRIVACY_PROOFS_ZK_LIB_GF2K_SYSDEP_H_
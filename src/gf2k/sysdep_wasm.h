@@ -20,6 +20,9 @@
 
 #include <cstdint>
 #include <wasm_simd128.h>
+
+#include "gf2k/clmul64.h"
+
 namespace proofs {
 using gf2_128_elt_t = v128_t;
 // trivial identity operations to provide the same function signatures
@@ -35,83 +38,40 @@ static inline gf2_128_elt_t gf2_128_add(gf2_128_elt_t x, gf2_128_elt_t y) {
   return wasm_v128_xor(x, y);
 }
 
-// Carryless multiplication of two 64-bit integers
-// Helper function for 64x64->128 carryless multiply
-static inline void clmul64(uint64_t a, uint64_t b, uint64_t* hi, uint64_t* lo) {
-  *lo = 0;
-  *hi = 0;
-  for (int i = 0; i < 64; ++i) {
-    if ((b >> i) & 1) {
-      *lo ^= a << i;
-      if (i > 0) *hi ^= a >> (64 - i);
-    }
-  }
+// clmul64() comes from gf2k/clmul64.h.  wasm has a native i64.mul,
+// while i64x2.mul is emulated by the engines on both x86-64 and arm64,
+// so the multiplies there stay scalar.
+static inline v128_t clmul64_v128(uint64_t a, uint64_t b) {
+  uint64_t hi, lo;
+  clmul64(a, b, &hi, &lo);
+  return wasm_i64x2_make(lo, hi);
 }
 
-// Reduction modulo x^128 + x^7 + x^2 + x + 1
-static inline v128_t reduce(uint64_t r3, uint64_t r2, uint64_t r1, uint64_t r0) {
-  const uint64_t POLY = 0x87;
-
-  // First, compute the multiplication of the high 128 bits by POLY.
-  // C_H * POLY = (r3*x^64 + r2) * POLY
-  // This is equivalent to (r3*POLY)*x^64 + (r2*POLY)
-
-  uint64_t p1, p0;
-  clmul64(r2, POLY, &p1, &p0); // p = r2 * POLY
-
-  uint64_t q1, q0;
-  clmul64(r3, POLY, &q1, &q0); // q = r3 * POLY
-
-  // The full product C_H * POLY is q*x^64 + p.
-  // q*x^64 = (q1*x^64 + q0)*x^64 = q1*x^128 + q0*x^64
-  // modulo P(x), this is: q1*POLY + q0*x^64
-
-  // Combine the terms: C_H*POLY = q1*POLY + (q0+p1)*x^64 + p0
-  uint64_t m_hi = q0 ^ p1;
-  uint64_t m_lo = p0;
-
-  // Now, XOR this with the low 128 bits (r1, r0).
-  uint64_t res_hi = r1 ^ m_hi;
-  uint64_t res_lo = r0 ^ m_lo;
-
-  // Finally, XOR the remainder from the q1*x^128 term.
-  // q1 comes from clmul64(r3, POLY), where r3 is 64-bit and POLY is 8-bit.
-  // The product is at most 71 bits, so q1 has at most 7 non-zero bits.
-  // clmul64(q1, POLY) will produce a result less than 15 bits, so t1 will be 0.
-  uint64_t t1, t0;
-  clmul64(q1, POLY, &t1, &t0);
-
-  res_hi ^= t1;
-  res_lo ^= t0;
-
-  // The result (res_hi, res_lo) is now fully reduced.
-  return wasm_i64x2_make(res_lo, res_hi);
+// return t0 + x^64 * t1 modulo x^128 + x^7 + x^2 + x + 1
+static inline v128_t gf2_128_reduce(v128_t t0, v128_t t1) {
+  // x^64 * t1 = (t1_lo * x^64) + t1_hi * x^128, and x^128 = x^7 + x^2 +
+  // x + 1, so t1_hi folds back in as four shifted copies.  The product
+  // is at most 71 bits wide, so nothing is left over.
+  uint64_t t1_lo = wasm_i64x2_extract_lane(t1, 0);
+  uint64_t h = wasm_i64x2_extract_lane(t1, 1);
+  uint64_t lo = h ^ (h << 1) ^ (h << 2) ^ (h << 7);
+  uint64_t hi = t1_lo ^ (h >> 63) ^ (h >> 62) ^ (h >> 57);
+  return wasm_v128_xor(t0, wasm_i64x2_make(lo, hi));
 }
 
-// GF(2^128) multiplication
-static inline v128_t gf2_128_mul(v128_t a, v128_t b) {
-  uint64_t a0 = wasm_i64x2_extract_lane(a, 0);
-  uint64_t a1 = wasm_i64x2_extract_lane(a, 1);
-  uint64_t b0 = wasm_i64x2_extract_lane(b, 0);
-  uint64_t b1 = wasm_i64x2_extract_lane(b, 1);
-
-  uint64_t z0_hi, z0_lo;
-  uint64_t z1_hi, z1_lo;
-  uint64_t z2_hi, z2_lo;
-  uint64_t z3_hi, z3_lo;
-
-  clmul64(a0, b0, &z0_hi, &z0_lo);
-  clmul64(a0, b1, &z1_hi, &z1_lo);
-  clmul64(a1, b0, &z2_hi, &z2_lo);
-  clmul64(a1, b1, &z3_hi, &z3_lo);
-
-  // Combine results
-  uint64_t r0 = z0_lo;
-  uint64_t r1 = z0_hi ^ z1_lo ^ z2_lo;
-  uint64_t r2 = z1_hi ^ z2_hi ^ z3_lo;
-  uint64_t r3 = z3_hi;
-
-  return reduce(r3, r2, r1, r0);
+// Karatsuba terms, see gf2_128_mul() in sysdep.h
+static inline v128_t gf2_128_clmul_lo(v128_t a, v128_t b) {
+  return clmul64_v128(wasm_i64x2_extract_lane(a, 0),
+                      wasm_i64x2_extract_lane(b, 0));
+}
+static inline v128_t gf2_128_clmul_hi(v128_t a, v128_t b) {
+  return clmul64_v128(wasm_i64x2_extract_lane(a, 1),
+                      wasm_i64x2_extract_lane(b, 1));
+}
+static inline v128_t gf2_128_clmul_mid(v128_t a, v128_t b) {
+  uint64_t a01 = wasm_i64x2_extract_lane(a, 0) ^ wasm_i64x2_extract_lane(a, 1);
+  uint64_t b01 = wasm_i64x2_extract_lane(b, 0) ^ wasm_i64x2_extract_lane(b, 1);
+  return clmul64_v128(a01, b01);
 }
 
 }  // namespace proofs
@@ -10,6 +10,15 @@
 
 #include <string.h>
 #include "util/aes_ecb.h"
+#include "util/cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AES_HAVE_AESNI 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define AES_HAVE_ARMV8 1
+#endif
 
 #define Nb 4
 
@@ -120,11 +129,281 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
     }
 }
 
+#ifdef AES_HAVE_AESNI
+// AES-NI key expansion.  The round keys are stored in the same byte order
+// KeyExpansion() produces, so both Cipher() paths accept either schedule.
+
+// Next even round key: k0 ^= prefix-xor(k0) ^ broadcast(word 3 of t).
+#define AESNI_EXPAND_EVEN(k0, t)                                     \
+  do {                                                               \
+    __m128i s_ = _mm_slli_si128(k0, 4);                              \
+    k0 = _mm_xor_si128(k0, s_);                                      \
+    s_ = _mm_slli_si128(s_, 4);                                      \
+    k0 = _mm_xor_si128(k0, s_);                                      \
+    s_ = _mm_slli_si128(s_, 4);                                      \
+    k0 = _mm_xor_si128(k0, s_);                                      \
+    k0 = _mm_xor_si128(k0, _mm_shuffle_epi32(t, 0xff));             \
+  } while (0)
+
+// Next odd round key: SubWord without rotation or Rcon (word 2).
+#define AESNI_EXPAND_ODD(k1, k0)                                     \
+  do {                                                               \
+    __m128i t_ = _mm_aeskeygenassist_si128(k0, 0x00);                \
+    __m128i s_ = _mm_slli_si128(k1, 4);                              \
+    k1 = _mm_xor_si128(k1, s_);                                      \
+    s_ = _mm_slli_si128(s_, 4);                                      \
+    k1 = _mm_xor_si128(k1, s_);                                      \
+    s_ = _mm_slli_si128(s_, 4);                                      \
+    k1 = _mm_xor_si128(k1, s_);                                      \
+    k1 = _mm_xor_si128(k1, _mm_shuffle_epi32(t_, 0xaa));             \
+  } while (0)
+
+#define AESNI_EXPAND_PAIR(i, rcon)                                   \
+  do {                                                               \
+    AESNI_EXPAND_EVEN(k0, _mm_aeskeygenassist_si128(k1, rcon));      \
+    _mm_storeu_si128((__m128i*)(RoundKey + 32 * (i)), k0);           \
+    AESNI_EXPAND_ODD(k1, k0);                                        \
+    _mm_storeu_si128((__m128i*)(RoundKey + 32 * (i) + 16), k1);      \
+  } while (0)
+
+__attribute__((target("aes,sse2")))
+static void KeyExpansion_aesni(uint8_t* RoundKey, const uint8_t* Key)
+{
+  __m128i k0 = _mm_loadu_si128((const __m128i*)Key);
+  __m128i k1 = _mm_loadu_si128((const __m128i*)(Key + 16));
+
+  _mm_storeu_si128((__m128i*)RoundKey, k0);
+  _mm_storeu_si128((__m128i*)(RoundKey + 16), k1);
+  AESNI_EXPAND_PAIR(1, 0x01);
+  AESNI_EXPAND_PAIR(2, 0x02);
+  AESNI_EXPAND_PAIR(3, 0x04);
+  AESNI_EXPAND_PAIR(4, 0x08);
+  AESNI_EXPAND_PAIR(5, 0x10);
+  AESNI_EXPAND_PAIR(6, 0x20);
+  AESNI_EXPAND_EVEN(k0, _mm_aeskeygenassist_si128(k1, 0x40));
+  _mm_storeu_si128((__m128i*)(RoundKey + 32 * 7), k0);
+}
+
+#undef AESNI_EXPAND_PAIR
+#undef AESNI_EXPAND_ODD
+#undef AESNI_EXPAND_EVEN
+
+__attribute__((target("aes,sse2")))
+static void Cipher_aesni(uint8_t* buf, const uint8_t* RoundKey)
+{
+  const __m128i* rk = (const __m128i*)RoundKey;
+  __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)buf),
+                            _mm_loadu_si128(rk));
+  unsigned round;
+
+  for (round = 1; round < Nr; ++round)
+    {
+      b = _mm_aesenc_si128(b, _mm_loadu_si128(rk + round));
+    }
+  b = _mm_aesenclast_si128(b, _mm_loadu_si128(rk + Nr));
+  _mm_storeu_si128((__m128i*)buf, b);
+}
+
+// Eight independent blocks per iteration: aesenc has a latency of several
+// cycles but a throughput of one or two per cycle.
+#define AESNI_ROUND8(f, k)                                               \
+  do {                                                                   \
+    b0 = f(b0, k); b1 = f(b1, k); b2 = f(b2, k); b3 = f(b3, k);           \
+    b4 = f(b4, k); b5 = f(b5, k); b6 = f(b6, k); b7 = f(b7, k);           \
+  } while (0)
+
+__attribute__((target("aes,sse2")))
+static void Cipher_aesni_blocks(uint8_t* out, const uint8_t* in,
+                                size_t nblocks, const uint8_t* RoundKey)
+{
+  const __m128i* rk = (const __m128i*)RoundKey;
+  __m128i k[Nr + 1];
+  unsigned round;
+
+  for (round = 0; round <= Nr; ++round)
+    {
+      k[round] = _mm_loadu_si128(rk + round);
+    }
+
+  for (; nblocks >= 8; nblocks -= 8, in += 128, out += 128)
+    {
+      const __m128i* src = (const __m128i*)in;
+      __m128i* dst = (__m128i*)out;
+      __m128i b0 = _mm_loadu_si128(src + 0), b1 = _mm_loadu_si128(src + 1);
+      __m128i b2 = _mm_loadu_si128(src + 2), b3 = _mm_loadu_si128(src + 3);
+      __m128i b4 = _mm_loadu_si128(src + 4), b5 = _mm_loadu_si128(src + 5);
+      __m128i b6 = _mm_loadu_si128(src + 6), b7 = _mm_loadu_si128(src + 7);
+
+      AESNI_ROUND8(_mm_xor_si128, k[0]);
+      for (round = 1; round < Nr; ++round)
+        {
+          AESNI_ROUND8(_mm_aesenc_si128, k[round]);
+        }
+      AESNI_ROUND8(_mm_aesenclast_si128, k[Nr]);
+
+      _mm_storeu_si128(dst + 0, b0); _mm_storeu_si128(dst + 1, b1);
+      _mm_storeu_si128(dst + 2, b2); _mm_storeu_si128(dst + 3, b3);
+      _mm_storeu_si128(dst + 4, b4); _mm_storeu_si128(dst + 5, b5);
+      _mm_storeu_si128(dst + 6, b6); _mm_storeu_si128(dst + 7, b7);
+    }
+
+  for (; nblocks > 0; --nblocks, in += 16, out += 16)
+    {
+      __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), k[0]);
+      for (round = 1; round < Nr; ++round)
+        {
+          b = _mm_aesenc_si128(b, k[round]);
+        }
+      _mm_storeu_si128((__m128i*)out, _mm_aesenclast_si128(b, k[Nr]));
+    }
+}
+
+#undef AESNI_ROUND8
+
+static int aes_use_aesni(void)
+{
+  static const int use = cpu_has(CPU_FEATURE_AES);
+  return use;
+}
+#endif
+
+#ifdef AES_HAVE_ARMV8
+// ARMv8 Cryptography Extensions.  AESE is AddRoundKey+SubBytes+ShiftRows
+// and AESMC is MixColumns, so round r of FIPS-197 is AESMC(AESE(b, rk[r]))
+// shifted by one key, and the final AddRoundKey is a plain XOR.
+
+#if defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO)
+#define ARMV8_AES_TARGET
+#elif defined(__clang__)
+#define ARMV8_AES_TARGET __attribute__((target("crypto")))
+#else
+#define ARMV8_AES_TARGET __attribute__((target("+crypto")))
+#endif
+
+ARMV8_AES_TARGET
+static void Cipher_armv8(uint8_t* buf, const uint8_t* RoundKey)
+{
+  uint8x16_t b = vld1q_u8(buf);
+  unsigned round;
+
+  for (round = 0; round < Nr - 1; ++round)
+    {
+      b = vaesmcq_u8(vaeseq_u8(b, vld1q_u8(RoundKey + 16 * round)));
+    }
+  b = vaeseq_u8(b, vld1q_u8(RoundKey + 16 * (Nr - 1)));
+  b = veorq_u8(b, vld1q_u8(RoundKey + 16 * Nr));
+  vst1q_u8(buf, b);
+}
+
+// Four blocks per iteration; AESE/AESMC pairs fuse on most cores and
+// four independent chains cover their latency.
+#define ARMV8_ROUND4(k)                                                  \
+  do {                                                                   \
+    b0 = vaesmcq_u8(vaeseq_u8(b0, k)); b1 = vaesmcq_u8(vaeseq_u8(b1, k)); \
+    b2 = vaesmcq_u8(vaeseq_u8(b2, k)); b3 = vaesmcq_u8(vaeseq_u8(b3, k)); \
+  } while (0)
+
+ARMV8_AES_TARGET
+static void Cipher_armv8_blocks(uint8_t* out, const uint8_t* in,
+                                size_t nblocks, const uint8_t* RoundKey)
+{
+  uint8x16_t k[Nr + 1];
+  unsigned round;
+
+  for (round = 0; round <= Nr; ++round)
+    {
+      k[round] = vld1q_u8(RoundKey + 16 * round);
+    }
+
+  for (; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+    {
+      uint8x16_t b0 = vld1q_u8(in), b1 = vld1q_u8(in + 16);
+      uint8x16_t b2 = vld1q_u8(in + 32), b3 = vld1q_u8(in + 48);
+
+      for (round = 0; round < Nr - 1; ++round)
+        {
+          ARMV8_ROUND4(k[round]);
+        }
+      b0 = veorq_u8(vaeseq_u8(b0, k[Nr - 1]), k[Nr]);
+      b1 = veorq_u8(vaeseq_u8(b1, k[Nr - 1]), k[Nr]);
+      b2 = veorq_u8(vaeseq_u8(b2, k[Nr - 1]), k[Nr]);
+      b3 = veorq_u8(vaeseq_u8(b3, k[Nr - 1]), k[Nr]);
+      vst1q_u8(out, b0); vst1q_u8(out + 16, b1);
+      vst1q_u8(out + 32, b2); vst1q_u8(out + 48, b3);
+    }
+
+  for (; nblocks > 0; --nblocks, in += 16, out += 16)
+    {
+      uint8x16_t b = vld1q_u8(in);
+      for (round = 0; round < Nr - 1; ++round)
+        {
+          b = vaesmcq_u8(vaeseq_u8(b, k[round]));
+        }
+      vst1q_u8(out, veorq_u8(vaeseq_u8(b, k[Nr - 1]), k[Nr]));
+    }
+}
+
+#undef ARMV8_ROUND4
+
+static int aes_use_armv8(void)
+{
+  static const int use = cpu_has(CPU_FEATURE_ARM_AES);
+  return use;
+}
+#endif
+
+// AES_init_ctx_cached() remembers expanded keys per thread: a transcript
+// re-keys the PRF from the same hash state on every squeeze, and a lookup
+// is several times cheaper than either key expansion.  The cache keeps
+// keys for the life of the thread, so it is for public keys only.
+#define KS_CACHE_ENTRIES 4
+
+struct ks_cache_entry
+{
+  uint8_t key[AES_KEYLEN];
+  uint8_t RoundKey[AES_keyExpSize];
+  int valid;
+};
+
+static void KeyExpansion_any(uint8_t* RoundKey, const uint8_t* Key)
+{
+#ifdef AES_HAVE_AESNI
+  if (aes_use_aesni()) {
+    KeyExpansion_aesni(RoundKey, Key);
+    return;
+  }
+#endif
+  KeyExpansion(RoundKey, Key);
+}
+
 void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key)
 {
-  KeyExpansion(ctx->RoundKey, key);
+  KeyExpansion_any(ctx->RoundKey, key);
 }
 
+void AES_init_ctx_cached(struct AES_ctx* ctx, const uint8_t* key)
+{
+  static thread_local struct ks_cache_entry cache[KS_CACHE_ENTRIES];
+  static thread_local unsigned next;
+  unsigned i;
+
+  for (i = 0; i < KS_CACHE_ENTRIES; ++i)
+    {
+      if (cache[i].valid && memcmp(cache[i].key, key, AES_KEYLEN) == 0) {
+        memcpy(ctx->RoundKey, cache[i].RoundKey, AES_keyExpSize);
+        return;
+      }
+    }
+  KeyExpansion_any(ctx->RoundKey, key);
+  i = next;
+  next = (next + 1) % KS_CACHE_ENTRIES;
+  memcpy(cache[i].key, key, AES_KEYLEN);
+  memcpy(cache[i].RoundKey, ctx->RoundKey, AES_keyExpSize);
+  cache[i].valid = 1;
+}
+
+#undef KS_CACHE_ENTRIES
+
 static void AddRoundKey(uint8_t round, state_t* state, const uint8_t* RoundKey)
 {
   uint8_t i,j;
@@ -222,9 +501,386 @@ static void Cipher(state_t* state, const uint8_t* RoundKey)
 }
 
 
+// Bitsliced AES for bulk encryption on targets without AES instructions.
+// No table lookups, so the running time does not depend on the key or the
+// data.  Four blocks are processed together: q[j] holds bit j of every
+// byte, with byte i of block b at bit position 16 * b + i (i = 4 * column
+// + row, the usual AES byte order).  Each round key is sliced the same way,
+// replicated across the four blocks.
+
+#define BS_BLOCKS 4
+
+// Transposes the 8x8 bit matrix held in x (byte i, bit j) <-> (byte j, bit i).
+static uint64_t bs_transpose8x8(uint64_t x)
+{
+  uint64_t t;
+
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+// Swaps bytes: word k byte j <-> word j byte k.
+static void bs_transpose_bytes(uint64_t q[8])
+{
+  uint64_t r[8] = { 0 };
+  unsigned j, k;
+
+  for (j = 0; j < 8; ++j)
+    {
+      for (k = 0; k < 8; ++k)
+        {
+          r[j] |= ((q[k] >> (8 * j)) & 0xff) << (8 * k);
+        }
+    }
+  memcpy(q, r, sizeof(r));
+}
+
+static void bs_load(uint64_t q[8], const uint8_t* in)
+{
+  unsigned i, k;
+
+  for (k = 0; k < 8; ++k)
+    {
+      uint64_t w = 0;
+      for (i = 0; i < 8; ++i)
+        {
+          w |= (uint64_t)in[8 * k + i] << (8 * i);
+        }
+      q[k] = bs_transpose8x8(w);
+    }
+  bs_transpose_bytes(q);
+}
+
+static void bs_store(uint8_t* out, const uint64_t q[8])
+{
+  uint64_t w[8];
+  unsigned i, k;
+
+  memcpy(w, q, sizeof(w));
+  bs_transpose_bytes(w);
+  for (k = 0; k < 8; ++k)
+    {
+      uint64_t x = bs_transpose8x8(w[k]);
+      for (i = 0; i < 8; ++i)
+        {
+          out[8 * k + i] = (uint8_t)(x >> (8 * i));
+        }
+    }
+}
+
+// S-box circuit of Boyar and Peralta (113 gates, depth 16).
+static void bs_SubBytes(uint64_t q[8])
+{
+  uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+  uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11;
+  uint64_t y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+  uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+  uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+  uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+  uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+  uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+  uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+  uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+  uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+  uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+  uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+  x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+  x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+  // Top linear transformation.
+  y14 = x3 ^ x5;
+  y13 = x0 ^ x6;
+  y9 = x0 ^ x3;
+  y8 = x0 ^ x5;
+  t0 = x1 ^ x2;
+  y1 = t0 ^ x7;
+  y4 = y1 ^ x3;
+  y12 = y13 ^ y14;
+  y2 = y1 ^ x0;
+  y5 = y1 ^ x6;
+  y3 = y5 ^ y8;
+  t1 = x4 ^ y12;
+  y15 = t1 ^ x5;
+  y20 = t1 ^ x1;
+  y6 = y15 ^ x7;
+  y10 = y15 ^ t0;
+  y11 = y20 ^ y9;
+  y7 = x7 ^ y11;
+  y17 = y10 ^ y11;
+  y19 = y10 ^ y8;
+  y16 = t0 ^ y11;
+  y21 = y13 ^ y16;
+  y18 = x0 ^ y16;
+
+  // Non-linear section.
+  t2 = y12 & y15;
+  t3 = y3 & y6;
+  t4 = t3 ^ t2;
+  t5 = y4 & x7;
+  t6 = t5 ^ t2;
+  t7 = y13 & y16;
+  t8 = y5 & y1;
+  t9 = t8 ^ t7;
+  t10 = y2 & y7;
+  t11 = t10 ^ t7;
+  t12 = y9 & y11;
+  t13 = y14 & y17;
+  t14 = t13 ^ t12;
+  t15 = y8 & y10;
+  t16 = t15 ^ t12;
+  t17 = t4 ^ t14;
+  t18 = t6 ^ t16;
+  t19 = t9 ^ t14;
+  t20 = t11 ^ t16;
+  t21 = t17 ^ y20;
+  t22 = t18 ^ y19;
+  t23 = t19 ^ y21;
+  t24 = t20 ^ y18;
+
+  t25 = t21 ^ t22;
+  t26 = t21 & t23;
+  t27 = t24 ^ t26;
+  t28 = t25 & t27;
+  t29 = t28 ^ t22;
+  t30 = t23 ^ t24;
+  t31 = t22 ^ t26;
+  t32 = t31 & t30;
+  t33 = t32 ^ t24;
+  t34 = t23 ^ t33;
+  t35 = t27 ^ t33;
+  t36 = t24 & t35;
+  t37 = t36 ^ t34;
+  t38 = t27 ^ t36;
+  t39 = t29 & t38;
+  t40 = t25 ^ t39;
+
+  t41 = t40 ^ t37;
+  t42 = t29 ^ t33;
+  t43 = t29 ^ t40;
+  t44 = t33 ^ t37;
+  t45 = t42 ^ t41;
+  z0 = t44 & y15;
+  z1 = t37 & y6;
+  z2 = t33 & x7;
+  z3 = t43 & y16;
+  z4 = t40 & y1;
+  z5 = t29 & y7;
+  z6 = t42 & y11;
+  z7 = t45 & y17;
+  z8 = t41 & y10;
+  z9 = t44 & y12;
+  z10 = t37 & y3;
+  z11 = t33 & y4;
+  z12 = t43 & y13;
+  z13 = t40 & y5;
+  z14 = t29 & y2;
+  z15 = t42 & y9;
+  z16 = t45 & y14;
+  z17 = t41 & y8;
+
+  // Bottom linear transformation.
+  t46 = z15 ^ z16;
+  t47 = z10 ^ z11;
+  t48 = z5 ^ z13;
+  t49 = z9 ^ z10;
+  t50 = z2 ^ z12;
+  t51 = z2 ^ z5;
+  t52 = z7 ^ z8;
+  t53 = z0 ^ z3;
+  t54 = z6 ^ z7;
+  t55 = z16 ^ z17;
+  t56 = z12 ^ t48;
+  t57 = t50 ^ t53;
+  t58 = z4 ^ t46;
+  t59 = z3 ^ t54;
+  t60 = t46 ^ t57;
+  t61 = z14 ^ t57;
+  t62 = t52 ^ t58;
+  t63 = t49 ^ t58;
+  t64 = z4 ^ t59;
+  t65 = t61 ^ t62;
+  t66 = z1 ^ t63;
+  s0 = t59 ^ t63;
+  s6 = t56 ^ ~t62;
+  s7 = t48 ^ ~t60;
+  t67 = t64 ^ t65;
+  s3 = t53 ^ t66;
+  s4 = t51 ^ t66;
+  s5 = t47 ^ t65;
+  s1 = t64 ^ ~s3;
+  s2 = t55 ^ ~t67;
+
+  q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+  q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+// Row r moves left by r columns: within each 16-bit block, the bits of
+// row r rotate right by 4 * r positions.
+static uint64_t bs_shift_row_word(uint64_t x)
+{
+  return (x & 0x1111111111111111ULL)
+    | ((x >> 4) & 0x0222022202220222ULL) | ((x << 12) & 0x2000200020002000ULL)
+    | ((x >> 8) & 0x0044004400440044ULL) | ((x << 8) & 0x4400440044004400ULL)
+    | ((x >> 12) & 0x0008000800080008ULL) | ((x << 4) & 0x8880888088808880ULL);
+}
+
+static void bs_ShiftRows(uint64_t q[8])
+{
+  unsigned j;
+
+  for (j = 0; j < 8; ++j)
+    {
+      q[j] = bs_shift_row_word(q[j]);
+    }
+}
+
+// Rotations of the four rows within each column (nibble): bit 4c+r of
+// the result is bit 4c+((r+k)%4) of x.
+#define BS_ROT1(x) ((((x) >> 1) & 0x7777777777777777ULL) | (((x) << 3) & 0x8888888888888888ULL))
+#define BS_ROT2(x) ((((x) >> 2) & 0x3333333333333333ULL) | (((x) << 2) & 0xCCCCCCCCCCCCCCCCULL))
+
+// out_r = 2 * (a_r ^ a_{r+1}) ^ a_{r+1} ^ a_{r+2} ^ a_{r+3}
+static void bs_MixColumns(uint64_t q[8])
+{
+  uint64_t t[8], u[8];
+  unsigned j;
+
+  for (j = 0; j < 8; ++j)
+    {
+      uint64_t r1 = BS_ROT1(q[j]);
+      t[j] = q[j] ^ r1;
+      u[j] = r1 ^ BS_ROT2(t[j]);
+    }
+  q[0] = t[7] ^ u[0];
+  q[1] = t[0] ^ t[7] ^ u[1];
+  q[2] = t[1] ^ u[2];
+  q[3] = t[2] ^ t[7] ^ u[3];
+  q[4] = t[3] ^ t[7] ^ u[4];
+  q[5] = t[4] ^ u[5];
+  q[6] = t[5] ^ u[6];
+  q[7] = t[6] ^ u[7];
+}
+
+#undef BS_ROT2
+#undef BS_ROT1
+
+static void bs_AddRoundKey(uint64_t q[8], const uint64_t* sk)
+{
+  unsigned j;
+
+  for (j = 0; j < 8; ++j)
+    {
+      q[j] ^= sk[j];
+    }
+}
+
+/* Zero key-dependent scratch; the volatile stores are not elided as dead. */
+static void bs_wipe(void* p, size_t n)
+{
+  volatile uint8_t* v = (volatile uint8_t*)p;
+
+  while (n-- > 0)
+    {
+      *v++ = 0;
+    }
+}
+
+static void bs_KeyExpansion(uint64_t sk[8 * (Nr + 1)], const uint8_t* RoundKey)
+{
+  uint8_t rep[AES_BLOCKLEN * BS_BLOCKS];
+  unsigned round, b;
+
+  for (round = 0; round <= Nr; ++round)
+    {
+      for (b = 0; b < BS_BLOCKS; ++b)
+        {
+          memcpy(rep + AES_BLOCKLEN * b, RoundKey + AES_BLOCKLEN * round,
+                 AES_BLOCKLEN);
+        }
+      bs_load(sk + 8 * round, rep);
+    }
+  bs_wipe(rep, sizeof(rep));
+}
+
+static void Cipher_bitsliced_blocks(uint8_t* out, const uint8_t* in,
+                                    size_t nblocks, const uint8_t* RoundKey)
+{
+  uint64_t sk[8 * (Nr + 1)];
+  uint64_t q[8];
+  uint8_t buf[AES_BLOCKLEN * BS_BLOCKS];
+  unsigned round;
+
+  bs_KeyExpansion(sk, RoundKey);
+  while (nblocks > 0)
+    {
+      size_t n = nblocks < BS_BLOCKS ? nblocks : BS_BLOCKS;
+
+      memset(buf, 0, sizeof(buf));
+      memcpy(buf, in, AES_BLOCKLEN * n);
+      bs_load(q, buf);
+
+      bs_AddRoundKey(q, sk);
+      for (round = 1; round < Nr; ++round)
+        {
+          bs_SubBytes(q);
+          bs_ShiftRows(q);
+          bs_MixColumns(q);
+          bs_AddRoundKey(q, sk + 8 * round);
+        }
+      bs_SubBytes(q);
+      bs_ShiftRows(q);
+      bs_AddRoundKey(q, sk + 8 * Nr);
+
+      bs_store(buf, q);
+      memcpy(out, buf, AES_BLOCKLEN * n);
+      in += AES_BLOCKLEN * n;
+      out += AES_BLOCKLEN * n;
+      nblocks -= n;
+    }
+  /* The caller may be a DRBG refill: leave neither key nor output behind. */
+  bs_wipe(sk, sizeof(sk));
+  bs_wipe(q, sizeof(q));
+  bs_wipe(buf, sizeof(buf));
+}
+
 void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf)
 {
+#ifdef AES_HAVE_AESNI
+  if (aes_use_aesni()) {
+    Cipher_aesni(buf, ctx->RoundKey);
+    return;
+  }
+#endif
+#ifdef AES_HAVE_ARMV8
+  if (aes_use_armv8()) {
+    Cipher_armv8(buf, ctx->RoundKey);
+    return;
+  }
+#endif
   // The next function call encrypts the PlainText with the Key using AES algorithm.
   Cipher((state_t*)buf, ctx->RoundKey);
 }
 
+void AES_ECB_encrypt_blocks(const struct AES_ctx* ctx, uint8_t* out,
+                            const uint8_t* in, size_t nblocks)
+{
+#ifdef AES_HAVE_AESNI
+  if (aes_use_aesni()) {
+    Cipher_aesni_blocks(out, in, nblocks, ctx->RoundKey);
+    return;
+  }
+#endif
+#ifdef AES_HAVE_ARMV8
+  if (aes_use_armv8()) {
+    Cipher_armv8_blocks(out, in, nblocks, ctx->RoundKey);
+    return;
+  }
+#endif
+  Cipher_bitsliced_blocks(out, in, nblocks, ctx->RoundKey);
+}
@@ -20,6 +20,18 @@ struct AES_ctx
 
 void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key);
 
+// Same as AES_init_ctx, but looks the key up in a small per-thread cache of
+// expanded schedules first.  The cache keeps the key and its schedule for
+// the life of the thread: use it only for public keys, e.g. ones derived
+// from a Fiat-Shamir transcript, never for secrets.
+void AES_init_ctx_cached(struct AES_ctx* ctx, const uint8_t* key);
+
 void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf);
 
+// Encrypts nblocks independent 16-byte blocks from in to out (which may
+// alias).  Equivalent to calling AES_ECB_encrypt on each block, but keeps
+// several blocks in flight to hide the AES round latency.
+void AES_ECB_encrypt_blocks(const struct AES_ctx* ctx, uint8_t* out,
+                            const uint8_t* in, size_t nblocks);
+
 #endif
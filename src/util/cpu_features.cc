@@ -0,0 +1,96 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "util/cpu_features.h"
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+/* Register state the OS saves on context switch (XCR0). */
+static uint64_t cpu_xgetbv0(void) {
+    uint32_t lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t) hi << 32) | lo;
+}
+
+static uint32_t cpu_features_probe(void) {
+    unsigned int eax, ebx, ecx, edx;
+    uint32_t features = 0;
+    uint64_t xcr0 = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    if (ecx & bit_SSSE3) features |= CPU_FEATURE_SSSE3;
+    if (ecx & bit_SSE4_1) features |= CPU_FEATURE_SSE41;
+    if (ecx & bit_AES) features |= CPU_FEATURE_AES;
+    if (ecx & bit_PCLMUL) features |= CPU_FEATURE_PCLMUL;
+    if (ecx & bit_OSXSAVE) xcr0 = cpu_xgetbv0();
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        if (ebx & bit_SHA) features |= CPU_FEATURE_SHA;
+        if (ecx & bit_VPCLMULQDQ) features |= CPU_FEATURE_VPCLMUL;
+        /* XMM|YMM */
+        if ((ebx & bit_AVX2) && (xcr0 & 0x06) == 0x06) {
+            features |= CPU_FEATURE_AVX2;
+        }
+        /* XMM|YMM|opmask|ZMM_Hi256|Hi16_ZMM */
+        if ((ebx & bit_AVX512F) && (xcr0 & 0xe6) == 0xe6) {
+            features |= CPU_FEATURE_AVX512F;
+        }
+    }
+    return features;
+}
+#elif defined(__aarch64__)
+static uint32_t cpu_features_probe(void) {
+    uint32_t features = 0;
+
+#if defined(__linux__) && !defined(__APPLE__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    if (hwcap & HWCAP_SHA2) features |= CPU_FEATURE_ARM_SHA2;
+    if (hwcap & HWCAP_AES) features |= CPU_FEATURE_ARM_AES;
+#endif
+    /* Baseline for the target (and for every Apple arm64 core). */
+#if defined(__ARM_FEATURE_SHA2) || defined(__APPLE__)
+    features |= CPU_FEATURE_ARM_SHA2;
+#endif
+#if defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO) || \
+    defined(__APPLE__)
+    features |= CPU_FEATURE_ARM_AES;
+#endif
+    return features;
+}
+#else
+static uint32_t cpu_features_probe(void) {
+    return 0;
+}
+#endif
+
+uint32_t cpu_features(void) {
+    static const uint32_t features = cpu_features_probe();
+    return features;
+}
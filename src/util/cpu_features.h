@@ -0,0 +1,35 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stdint.h>
+
+/* Instruction set extensions that have an optimized code path somewhere in
+   this library.  The probe runs once; callers test the bits they need. */
+
+#define CPU_FEATURE_SSSE3   (1u << 0)
+#define CPU_FEATURE_SSE41   (1u << 1)
+#define CPU_FEATURE_SHA     (1u << 2)   /* x86 SHA extensions (SHA-NI) */
+#define CPU_FEATURE_AVX2    (1u << 3)   /* AVX2, with YMM state enabled */
+#define CPU_FEATURE_AVX512F (1u << 4)   /* AVX-512F, with ZMM state enabled */
+#define CPU_FEATURE_AES     (1u << 5)   /* AES-NI */
+#define CPU_FEATURE_VPCLMUL (1u << 6)   /* VPCLMULQDQ (256/512-bit CLMUL) */
+#define CPU_FEATURE_PCLMUL  (1u << 7)   /* PCLMULQDQ */
+
+#define CPU_FEATURE_ARM_SHA2 (1u << 16) /* ARMv8 SHA-256 instructions */
+#define CPU_FEATURE_ARM_AES  (1u << 17) /* ARMv8 AES instructions */
+
+/**
+ * Return the set of CPU_FEATURE_* bits supported by the host.
+ *
+ * The CPU is probed on the first call and the result is cached.
+ */
+uint32_t cpu_features(void);
+
+/**
+ * Convenience wrapper: nonzero iff all of the requested bits are supported.
+ */
+static inline int cpu_has(uint32_t mask) {
+    return (cpu_features() & mask) == mask;
+}
+
+#endif
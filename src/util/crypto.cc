@@ -20,21 +20,124 @@
 
 #include "util/crypto.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__wasi__) && \
+    !defined(__EMSCRIPTEN__)
+#include <pthread.h>
+#define PROOFS_HAVE_FORK 1
+#endif
 
 // from zenroom
 extern "C" {
 #include <util/randombytes.h>
 }
 
+#include "util/aes_ecb.h"
 #include "util/panic.h"
 
 namespace proofs {
 
-void rand_bytes(uint8_t out[/*n*/], size_t n) {
-  int ret = randombytes(out, n);
+namespace {
+
+// Bumped in the child after fork(), so that a RandomPool inherited from the
+// parent reseeds instead of replaying the parent's stream.
+std::atomic<uint64_t> fork_generation{0};
+
+#ifdef PROOFS_HAVE_FORK
+void on_fork_child() { fork_generation.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+void register_fork_handler() {
+#ifdef PROOFS_HAVE_FORK
+  static const bool registered =
+      pthread_atfork(nullptr, nullptr, on_fork_child) == 0;
+  check(registered, "pthread_atfork failed");
+#endif
+}
+
+void secure_wipe(void* p, size_t n) {
+  volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+  while (n-- > 0) *v++ = 0;
+}
+
+}  // namespace
+
+RandomPool::~RandomPool() {
+  secure_wipe(key_, sizeof(key_));
+  secure_wipe(stream_, sizeof(stream_));
+}
+
+void RandomPool::Generate(uint8_t out[/*n*/], size_t n) {
+  uint64_t gen = fork_generation.load(std::memory_order_relaxed);
+  if (!seeded_ || gen != generation_) {
+    Reseed(gen);
+  }
+  while (n > 0) {
+    // Checked per refill, so that a single large request reseeds too.
+    if (pos_ == sizeof(stream_)) {
+      if (since_reseed_ >= kReseedBytes) {
+        Reseed(gen);
+      } else {
+        Refill();
+      }
+    }
+    size_t k = sizeof(stream_) - pos_;
+    if (k > n) k = n;
+    memcpy(out, stream_ + pos_, k);
+    secure_wipe(stream_ + pos_, k);
+    pos_ += k;
+    out += k;
+    n -= k;
+  }
+}
+
+void RandomPool::Reseed(uint64_t gen) {
+  uint8_t seed[kKeyBytes];
+  int ret = randombytes(seed, sizeof(seed));
   check(ret == 0, "randombytes failed");
+  // check() only logs; never run the pool on an unseeded key.
+  if (ret != 0) abort();
+  for (size_t i = 0; i < kKeyBytes; ++i) key_[i] ^= seed[i];
+  secure_wipe(seed, sizeof(seed));
+  register_fork_handler();
+  generation_ = gen;
+  since_reseed_ = 0;
+  seeded_ = true;
+  Refill();
+}
+
+void RandomPool::Refill() {
+  constexpr size_t kBlocks = sizeof(stream_) / AES_BLOCKLEN;
+  AES_ctx ctx;
+  AES_init_ctx(&ctx, key_);
+  memset(stream_, 0, sizeof(stream_));
+  for (size_t i = 0; i < kBlocks; ++i) {
+    uint64_t c = i;
+    for (size_t j = 0; j < 8; ++j) {
+      stream_[AES_BLOCKLEN * i + j] = static_cast<uint8_t>(c & 0xff);
+      c >>= 8;
+    }
+  }
+  AES_ECB_encrypt_blocks(&ctx, stream_, stream_, kBlocks);
+  secure_wipe(&ctx, sizeof(ctx));
+  memcpy(key_, stream_, kKeyBytes);
+  secure_wipe(stream_, kKeyBytes);
+  pos_ = kKeyBytes;
+  since_reseed_ += kBufferBytes;
+}
+
+RandomPool& thread_random_pool() {
+  static thread_local RandomPool pool;
+  return pool;
+}
+
+void rand_bytes(uint8_t out[/*n*/], size_t n) {
+  thread_random_pool().Generate(out, n);
 }
 
 void hex_to_str(char out[/* 2*n + 1*/], const uint8_t in[/*n*/], size_t n) {
@@ -50,7 +50,6 @@ namespace proofs {
 	class SHA256 {
 	public:
 		SHA256() {
-			state_.ctx = internal_ctx_buffer_;
 			sha256_inc_init(&state_);
 		}
 		SHA256(const SHA256&) = delete;
@@ -100,28 +99,168 @@ namespace proofs {
 			buffer_size_ = src.buffer_size_;
 			finalized_ = src.finalized_;
 		}
-		void Update8(uint64_t x) {
-			uint8_t buf[8];
+		// Saved hash state: chaining value plus any buffered partial block.
+		// A plain value, so it can be stored and restored any number of times.
+		struct Midstate {
+			sha256ctx state;
+			uint8_t buffer_data[kSHA256BlockSize];
+			size_t buffer_size;
+			bool finalized;
+		};
+		void Snapshot(Midstate* m) const {
+			m->state = state_;
+			memcpy(m->buffer_data, buffer_data_, buffer_size_);
+			m->buffer_size = buffer_size_;
+			m->finalized = finalized_;
+		}
+		void Restore(const Midstate& m) {
+			state_ = m.state;
+			memcpy(buffer_data_, m.buffer_data, m.buffer_size);
+			buffer_size_ = m.buffer_size;
+			finalized_ = m.finalized;
+		}
+		void Update8(uint64_t x) { UpdateU64Span(&x, 1); }
+
+		// Absorbs N words, each serialized little-endian as by Update8(),
+		// writing straight into the block buffer and compressing full
+		// blocks in place.
+		void UpdateU64Span(const uint64_t* words, size_t n) {
+			if (finalized_) {
+				ReInit();
+			}
+			if (buffer_size_ % 8 != 0) {
+				// Words would straddle blocks; take the generic path.
+				for (size_t i = 0; i < n; ++i) {
+					uint8_t buf[8];
+					store_le64(buf, words[i]);
+					Update(buf, 8);
+				}
+				return;
+			}
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			// The in-memory image of the span is already the byte stream.
+			if (buffer_size_ == 0 && n >= kSHA256BlockSize / 8) {
+				size_t nblocks = n / (kSHA256BlockSize / 8);
+				sha256_inc_blocks(&state_,
+						reinterpret_cast<const uint8_t*>(words), nblocks);
+				words += nblocks * (kSHA256BlockSize / 8);
+				n -= nblocks * (kSHA256BlockSize / 8);
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) {
+				store_le64(buffer_data_ + buffer_size_, words[i]);
+				buffer_size_ += 8;
+				if (buffer_size_ == kSHA256BlockSize) {
+					sha256_inc_blocks(&state_, buffer_data_, 1);
+					buffer_size_ = 0;
+				}
+			}
+		}
+
+		// Absorbs N field elements in their canonical byte encoding
+		// (F.to_bytes_field), serializing directly into the block buffer
+		// whenever the element fits in the remaining space.
+		template <class Field>
+		void UpdateElts(const Field& F, const typename Field::Elt* v,
+				size_t n) {
+			if (finalized_) {
+				ReInit();
+			}
+			for (size_t i = 0; i < n; ++i) {
+				if (buffer_size_ + Field::kBytes <= kSHA256BlockSize) {
+					F.to_bytes_field(buffer_data_ + buffer_size_, v[i]);
+					buffer_size_ += Field::kBytes;
+					if (buffer_size_ == kSHA256BlockSize) {
+						sha256_inc_blocks(&state_, buffer_data_, 1);
+						buffer_size_ = 0;
+					}
+				} else {
+					uint8_t buf[Field::kBytes];
+					F.to_bytes_field(buf, v[i]);
+					Update(buf, Field::kBytes);
+				}
+			}
+		}
+	private:
+		static void store_le64(uint8_t* p, uint64_t x) {
 			for (size_t i = 0; i < 8; ++i) {
-				buf[i] = static_cast<uint8_t>(x & 0xff);
+				p[i] = static_cast<uint8_t>(x & 0xff);
 				x >>= 8;
 			}
-			Update(buf, 8);
 		}
-	private:
 		void ReInit() {
-			state_.ctx = internal_ctx_buffer_;
 			sha256_inc_init(&state_);
 			buffer_size_ = 0;
 			finalized_ = false;
 		}
 		sha256ctx state_;
-		uint8_t internal_ctx_buffer_[40];
 		uint8_t buffer_data_[kSHA256BlockSize];
 		size_t buffer_size_ = 0;
 		bool finalized_ = false;
 	};
 
+	// Small cache of SHA256 midstates keyed by a caller-chosen 32-byte id
+	// (e.g. the hash of a circuit id and its domain-separation preamble).
+	// A transcript that always starts with the same prefix can absorb it
+	// once, Insert() the result, and Lookup() it on every later run instead
+	// of re-hashing identical bytes.  Entries are replaced round-robin.
+	// Not synchronized; use one cache per thread or guard it externally.
+	class SHA256MidstateCache {
+	public:
+		static constexpr size_t kEntries = 8;
+
+		SHA256MidstateCache() = default;
+		SHA256MidstateCache(const SHA256MidstateCache&) = delete;
+		SHA256MidstateCache& operator=(const SHA256MidstateCache&) = delete;
+
+		// On a hit, restores the cached midstate into H and returns true.
+		bool Lookup(const uint8_t id[kSHA256DigestSize], SHA256& H) const {
+			for (size_t i = 0; i < used_; ++i) {
+				if (memcmp(entries_[i].id, id, kSHA256DigestSize) == 0) {
+					H.Restore(entries_[i].m);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Records the current state of H under ID, replacing any entry
+		// with the same id.
+		void Insert(const uint8_t id[kSHA256DigestSize], const SHA256& H) {
+			Entry* e = nullptr;
+			for (size_t i = 0; i < used_; ++i) {
+				if (memcmp(entries_[i].id, id, kSHA256DigestSize) == 0) {
+					e = &entries_[i];
+					break;
+				}
+			}
+			if (e == nullptr) {
+				if (used_ < kEntries) {
+					e = &entries_[used_++];
+				} else {
+					e = &entries_[next_];
+					next_ = (next_ + 1) % kEntries;
+				}
+				memcpy(e->id, id, kSHA256DigestSize);
+			}
+			H.Snapshot(&e->m);
+		}
+
+		void Clear() {
+			used_ = 0;
+			next_ = 0;
+		}
+
+	private:
+		struct Entry {
+			uint8_t id[kSHA256DigestSize];
+			SHA256::Midstate m;
+		};
+		Entry entries_[kEntries];
+		size_t used_ = 0;
+		size_t next_ = 0;
+	};
+
 	class PRF {
 	public:
 		// Constants for PRF configuration
@@ -129,9 +268,19 @@ namespace proofs {
 		static constexpr size_t kPRFInputSize = 16;   // AES block size for input (16 bytes)
 		static constexpr size_t kPRFOutputSize = 16;  // AES block size for output (16 bytes)
 
+		// Whether the key may be kept in the per-thread schedule cache
+		// (see AES_init_ctx_cached).  Only keys derived from public data,
+		// such as a Fiat-Shamir transcript, may be kPublic.
+		enum class KeyKind { kSecret, kPublic };
+
 		// Constructor - takes 32-byte key for AES-256
-		explicit PRF(const uint8_t key[kPRFKeySize]) {
-			AES_init_ctx(&ctx_, key);  // Initialize with key
+		explicit PRF(const uint8_t key[kPRFKeySize],
+				KeyKind kind = KeyKind::kSecret) {
+			if (kind == KeyKind::kPublic) {
+				AES_init_ctx_cached(&ctx_, key);
+			} else {
+				AES_init_ctx(&ctx_, key);
+			}
 		}
 
 		// Destructor - no cleanup needed for stack-allocated ctx_
@@ -153,12 +302,98 @@ namespace proofs {
 
 			// Result is now in out buffer
 		}
+
+		// Evaluates the PRF on NBLOCKS independent inputs at once.  Same
+		// result as NBLOCKS calls to Eval(), but pipelined in hardware.
+		void EvalMany(uint8_t out[/*16*nblocks*/],
+				const uint8_t in[/*16*nblocks*/], size_t nblocks) {
+			AES_ECB_encrypt_blocks(&ctx_, out, in, nblocks);
+		}
+
+		// Counter-mode expansion: writes NBYTES of PRF output to OUT.
+		// Block i is the PRF evaluated on NONCE with its first 8 bytes,
+		// read as a little-endian uint64_t, incremented by i; the last
+		// block is truncated if NBYTES is not a multiple of 16.
+		void Stream(uint8_t out[/*nbytes*/], size_t nbytes,
+				const uint8_t nonce[kPRFInputSize]) {
+			constexpr size_t kChunk = 16;
+			uint8_t in[kChunk * kPRFInputSize];
+			uint8_t tmp[kChunk * kPRFOutputSize];
+			uint64_t ctr = 0;
+			for (size_t i = 0; i < 8; ++i) {
+				ctr |= static_cast<uint64_t>(nonce[i]) << (8 * i);
+			}
+			while (nbytes > 0) {
+				size_t nblocks = (nbytes + kPRFOutputSize - 1) / kPRFOutputSize;
+				if (nblocks > kChunk) nblocks = kChunk;
+				for (size_t b = 0; b < nblocks; ++b, ++ctr) {
+					uint8_t* blk = in + b * kPRFInputSize;
+					uint64_t c = ctr;
+					for (size_t i = 0; i < 8; ++i) {
+						blk[i] = static_cast<uint8_t>(c & 0xff);
+						c >>= 8;
+					}
+					memcpy(blk + 8, nonce + 8, kPRFInputSize - 8);
+				}
+				size_t n = nblocks * kPRFOutputSize;
+				if (n <= nbytes) {
+					EvalMany(out, in, nblocks);
+				} else {
+					EvalMany(tmp, in, nblocks);
+					memcpy(out, tmp, nbytes);
+					n = nbytes;
+				}
+				out += n;
+				nbytes -= n;
+			}
+		}
 	private:
 		AES_ctx ctx_;  // AES context that holds the expanded key schedule
 	};
 
+	// Buffered randomness source: AES-256-CTR with fast key erasure.  Each
+	// refill encrypts a counter under the current key, keeps the first 32
+	// bytes as the next key and hands out the rest, wiping bytes as they
+	// are consumed, so a compromised state reveals nothing about earlier
+	// output.  The key is mixed with fresh randombytes() output on first
+	// use, every kReseedBytes, and in the child after fork().
+	//
+	// A pool is not synchronized.  Each thread has its own through
+	// thread_random_pool(); a worker may also own one outright.  Pools are
+	// cache-line aligned so that neighbouring pools never share a line.
+	class alignas(64) RandomPool {
+	public:
+		static constexpr size_t kKeyBytes = 32;
+		static constexpr size_t kBufferBytes = 4096;
+		static constexpr uint64_t kReseedBytes = 1 << 20;
+
+		RandomPool() = default;
+		~RandomPool();
+		RandomPool(const RandomPool&) = delete;
+		RandomPool& operator=(const RandomPool&) = delete;
+
+		// Panics if the system entropy source fails.
+		void Generate(uint8_t out[/*n*/], size_t n);
+
+	private:
+		void Reseed(uint64_t generation);
+		void Refill();
+
+		uint8_t key_[kKeyBytes] = {};
+		// One AES pass yields the next key followed by kBufferBytes of
+		// output; bytes before pos_ have already been handed out and wiped.
+		uint8_t stream_[kKeyBytes + kBufferBytes];
+		size_t pos_ = kKeyBytes + kBufferBytes;
+		uint64_t since_reseed_ = 0;
+		uint64_t generation_ = 0;
+		bool seeded_ = false;
+	};
+
+// The calling thread's pool.  Lock-free: every thread seeds its own.
+RandomPool& thread_random_pool();
+
 // Generate n random bytes, following the openssl API convention.
-// This method will panic if the openssl library fails.
+// Draws from thread_random_pool(); panics if the entropy source fails.
 void rand_bytes(uint8_t out[/*n*/], size_t n);
 
 void hex_to_str(char out[/* 2*n + 1*/], const uint8_t in[/*n*/], size_t n);
@@ -36,6 +36,18 @@
 #include <chrono>
 #endif
 
+// The asynchronous sink only applies to the fprintf(stderr) backend, and
+// needs threads.
+#if !defined(__ANDROID__) && !defined(__ABSL__) && \
+    !defined(__EMSCRIPTEN__) && !defined(__wasi__)
+#define PROOFS_LOG_ASYNC 1
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#endif
+
 namespace proofs {
 
 // This implementation maintains its own error thresholds in order to
@@ -58,9 +70,153 @@ const char* level_str(enum LogLevel l) {
 }
 #endif
 
+#if defined(PROOFS_LOG_ASYNC)
+namespace {
+
+// Bounded multi-producer, single-consumer queue (Vyukov).  Each slot's
+// sequence number says whether it is free for ticket t (seq == t) or
+// holds the line for ticket t (seq == t + 1).
+constexpr size_t kQueueSlots = 1024;
+constexpr size_t kLineBytes = 1152;
+
+struct LogSlot {
+  std::atomic<size_t> seq;
+  size_t len;
+  char line[kLineBytes];
+};
+
+struct LogQueue {
+  LogSlot slots[kQueueSlots];
+  std::atomic<size_t> tail{0};
+  size_t head = 0;  // consumer only
+  std::atomic<bool> running{false};
+  std::atomic<size_t> dropped{0};
+  std::thread writer;
+
+  LogQueue() {
+    for (size_t i = 0; i < kQueueSlots; ++i) {
+      slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool push(const char* line, size_t len) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+      LogSlot& s = slots[pos % kQueueSlots];
+      size_t seq = s.seq.load(std::memory_order_acquire);
+      if (seq == pos) {
+        if (tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          if (len > kLineBytes) len = kLineBytes;
+          memcpy(s.line, line, len);
+          s.len = len;
+          s.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (seq < pos + 1) {
+        return false;  // full
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Writes every line published so far; returns false if there was none.
+  bool drain() {
+    bool any = false;
+    for (;;) {
+      LogSlot& s = slots[head % kQueueSlots];
+      if (s.seq.load(std::memory_order_acquire) != head + 1) break;
+      fwrite(s.line, 1, s.len, stderr);
+      s.seq.store(head + kQueueSlots, std::memory_order_release);
+      ++head;
+      any = true;
+    }
+    size_t d = dropped.exchange(0, std::memory_order_relaxed);
+    if (d > 0) {
+      fprintf(stderr, "[WARNING] log queue full, %zu lines dropped\n", d);
+    }
+    return any;
+  }
+
+  void run() {
+    while (running.load(std::memory_order_acquire)) {
+      if (!drain()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    }
+    drain();
+  }
+};
+
+LogQueue* _log_queue = nullptr;
+std::atomic<bool> _log_async{false};
+// emit() calls that may still push to the queue.
+std::atomic<size_t> _log_emitting{0};
+
+// Once _log_async is clear, new emit() calls write directly, but one that
+// saw it set may still be pushing after the writer has exited.  The
+// seq_cst pair (_log_emitting raised before _log_async is read, and read
+// after _log_async is cleared) lets stop_async() wait for those, and a
+// last drain() writes what they pushed.
+void stop_async() {
+  if (_log_queue != nullptr && _log_queue->running.load()) {
+    _log_async.store(false);
+    _log_queue->running.store(false, std::memory_order_release);
+    _log_queue->writer.join();
+    while (_log_emitting.load() != 0) {
+      std::this_thread::yield();
+    }
+    _log_queue->drain();
+  }
+}
+
+void emit(const char* line, size_t len) {
+  // The counter is only touched while async logging looks active, so the
+  // synchronous path shares no cache line between threads; the seq_cst
+  // re-check after raising it is what stop_async() relies on.
+  if (_log_async.load(std::memory_order_relaxed)) {
+    _log_emitting.fetch_add(1);
+    if (_log_async.load()) {
+      if (!_log_queue->push(line, len)) {
+        _log_queue->dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      _log_emitting.fetch_sub(1, std::memory_order_release);
+      return;
+    }
+    _log_emitting.fetch_sub(1, std::memory_order_release);
+  }
+  fwrite(line, 1, len, stderr);
+}
+
+}  // namespace
+
+void set_log_async(bool on) {
+  if (!on) {
+    stop_async();
+    return;
+  }
+  if (_log_queue == nullptr) {
+    _log_queue = new LogQueue;
+    atexit(stop_async);
+  }
+  if (!_log_queue->running.load()) {
+    _log_queue->running.store(true, std::memory_order_release);
+    _log_queue->writer = std::thread([] { _log_queue->run(); });
+    _log_async.store(true, std::memory_order_release);
+  }
+}
+#else
+void set_log_async(bool on) { (void)on; }
+#endif
+
 void set_log_level(enum LogLevel l) { _LOG_LEVEL = l; }
 
+bool log_enabled(enum LogLevel l) { return l <= _LOG_LEVEL; }
+
 void log(enum LogLevel l, const char* format, ...) {
+  if (l > _LOG_LEVEL) return;
+
   va_list args;
   va_start(args, format);
   char tmp[1024];
@@ -68,59 +224,61 @@ void log(enum LogLevel l, const char* format, ...) {
   va_end(args);
 
 #if defined(__ANDROID__)
-  if (l <= _LOG_LEVEL) {
-    switch (l) {
-      case ERROR:
-        __android_log_print(ANDROID_LOG_ERROR, "proofs", "%s", tmp);
-        break;
-      case WARNING:
-        __android_log_print(ANDROID_LOG_WARN, "proofs", "%s", tmp);
-        break;
-      case INFO:
-        __android_log_print(ANDROID_LOG_INFO, "proofs", "%s", tmp);
-        break;
-    }
+  switch (l) {
+    case ERROR:
+      __android_log_print(ANDROID_LOG_ERROR, "proofs", "%s", tmp);
+      break;
+    case WARNING:
+      __android_log_print(ANDROID_LOG_WARN, "proofs", "%s", tmp);
+      break;
+    case INFO:
+      __android_log_print(ANDROID_LOG_INFO, "proofs", "%s", tmp);
+      break;
   }
 #elif defined(__ABSL__)
-  if (l <= _LOG_LEVEL) {
-    switch (l) {
-      case LogLevel::ERROR:
-        LOG(ERROR) << tmp;
-        break;
-      case LogLevel::WARNING:
-        LOG(WARNING) << tmp;
-        break;
-      case LogLevel::INFO:
-        LOG(INFO) << tmp;
-        break;
-    }
+  switch (l) {
+    case LogLevel::ERROR:
+      LOG(ERROR) << tmp;
+      break;
+    case LogLevel::WARNING:
+      LOG(WARNING) << tmp;
+      break;
+    case LogLevel::INFO:
+      LOG(INFO) << tmp;
+      break;
   }
 #elif defined(__EMSCRIPTEN__)
-  if (l <= _LOG_LEVEL) {
-    switch (l) {
-      case ERROR:
-        EM_ASM({ console.error(UTF8ToString($0)); }, tmp);
-        break;
-      case WARNING:
-        EM_ASM({ console.warn(UTF8ToString($0)); }, tmp);
-        break;
-      case INFO:
-        EM_ASM({ console.log(UTF8ToString($0)); }, tmp);
-        break;
-    }
+  switch (l) {
+    case ERROR:
+      EM_ASM({ console.error(UTF8ToString($0)); }, tmp);
+      break;
+    case WARNING:
+      EM_ASM({ console.warn(UTF8ToString($0)); }, tmp);
+      break;
+    case INFO:
+      EM_ASM({ console.log(UTF8ToString($0)); }, tmp);
+      break;
   }
 #else
   using microseconds = std::chrono::microseconds;
   using milliseconds = std::chrono::milliseconds;
-  if (l <= _LOG_LEVEL) {
-    auto nt = std::chrono::steady_clock::now();
-    auto mus = std::chrono::duration_cast<microseconds>(nt - _last).count();
-    auto ms = std::chrono::duration_cast<milliseconds>(nt - _last).count();
-    mus -= ms * 1000;
-    _last = nt;
-    fprintf(stderr, "[%s][+%5llu.%.3llu ms] %s\n", level_str(_LOG_LEVEL),
-            static_cast<long long>(ms), static_cast<long long>(mus), tmp);
+  auto nt = std::chrono::steady_clock::now();
+  auto mus = std::chrono::duration_cast<microseconds>(nt - _last).count();
+  auto ms = std::chrono::duration_cast<milliseconds>(nt - _last).count();
+  mus -= ms * 1000;
+  _last = nt;
+#if defined(PROOFS_LOG_ASYNC)
+  char line[kLineBytes];
+  int n = snprintf(line, sizeof(line), "[%s][+%5llu.%.3llu ms] %s\n",
+                   level_str(l), static_cast<long long>(ms),
+                   static_cast<long long>(mus), tmp);
+  if (n > 0) {
+    emit(line, static_cast<size_t>(n) < sizeof(line) ? n : sizeof(line) - 1);
   }
+#else
+  fprintf(stderr, "[%s][+%5llu.%.3llu ms] %s\n", level_str(l),
+          static_cast<long long>(ms), static_cast<long long>(mus), tmp);
+#endif
 #endif
 }
 
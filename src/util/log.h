@@ -27,7 +27,40 @@ enum LogLevel {
 
 void set_log_level(enum LogLevel l);
 
+// True if a message at level L would be emitted.
+bool log_enabled(enum LogLevel l);
+
+// Formats and emits the message if L passes the current level; the level
+// is checked before any formatting work.
 void log(enum LogLevel l, const char* format, ...);
+
+// Hands formatted lines to a background writer thread through a lock-free
+// queue, so a slow stderr never blocks the caller.  Lines are dropped (and
+// counted) rather than waiting when the queue is full.  Pending lines are
+// flushed when async logging is turned off and at exit, including lines
+// from threads that were logging concurrently with the switch.  A no-op on
+// targets without threads or with a platform logger.
+void set_log_async(bool on);
 }  // namespace proofs
 
+// Messages above this level are compiled out by PROOFS_LOG.  Release builds
+// (-DPROOFS_LOG_RELEASE) keep only errors and warnings.
+#ifndef PROOFS_LOG_MAX_LEVEL
+#ifdef PROOFS_LOG_RELEASE
+#define PROOFS_LOG_MAX_LEVEL 10
+#else
+#define PROOFS_LOG_MAX_LEVEL 100
+#endif
+#endif
+
+// PROOFS_LOG(INFO, "fmt", ...): argument evaluation and formatting happen
+// only if the level is both compiled in and currently enabled.
+#define PROOFS_LOG(level, ...)                         \
+  do {                                                 \
+    if (::proofs::level <= PROOFS_LOG_MAX_LEVEL &&     \
+        ::proofs::log_enabled(::proofs::level)) {      \
+      ::proofs::log(::proofs::level, __VA_ARGS__);     \
+    }                                                  \
+  } while (0)
+
 #endif  // PRIVACY_PROOFS_ZK_LIB_UTIL_LOG_H_
@@ -0,0 +1,235 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "util/mem_accounting.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "util/log.h"
+
+namespace proofs {
+
+namespace {
+
+constexpr size_t kMaxPhases = 64;
+
+std::atomic<uint64_t> g_current{0};
+std::atomic<uint64_t> g_peak{0};
+
+// Fixed storage: recording a phase must not allocate.
+struct mem_phase_result g_phases[kMaxPhases];
+size_t g_num_phases = 0;
+
+void raise_peak(uint64_t v) {
+  uint64_t p = g_peak.load(std::memory_order_relaxed);
+  while (v > p &&
+         !g_peak.compare_exchange_weak(p, v, std::memory_order_relaxed)) {
+  }
+}
+
+struct mem_phase_result* find_phase(const char* name) {
+  for (size_t i = 0; i < g_num_phases; ++i) {
+    if (g_phases[i].name == name || strcmp(g_phases[i].name, name) == 0) {
+      return &g_phases[i];
+    }
+  }
+  if (g_num_phases == kMaxPhases) return nullptr;
+  struct mem_phase_result* p = &g_phases[g_num_phases++];
+  memset(p, 0, sizeof(*p));
+  p->name = name;
+  return p;
+}
+
+}  // namespace
+
+bool mem_accounting_available() {
+#if defined(PROOFS_MEM_ACCOUNTING)
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t mem_current_bytes() {
+  return g_current.load(std::memory_order_relaxed);
+}
+
+uint64_t mem_peak_bytes() { return g_peak.load(std::memory_order_relaxed); }
+
+void mem_account_alloc(size_t bytes) {
+  raise_peak(g_current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void mem_account_free(size_t bytes) {
+  g_current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// The global peak is reset to the current level on entry, so that on exit
+// it is this phase's high-water mark; the enclosing phase's peak is then
+// restored as the maximum of both.
+MemPhase::MemPhase(const char* name) : name_(name) {
+  start_ = mem_current_bytes();
+  saved_peak_ = g_peak.exchange(start_, std::memory_order_relaxed);
+}
+
+MemPhase::~MemPhase() {
+  uint64_t end = mem_current_bytes();
+  uint64_t peak = g_peak.load(std::memory_order_relaxed);
+  raise_peak(saved_peak_);
+  struct mem_phase_result* p = find_phase(name_);
+  if (p == nullptr) return;
+  p->calls++;
+  p->start_bytes = start_;
+  p->end_bytes = end;
+  if (peak > p->peak_bytes) p->peak_bytes = peak;
+}
+
+size_t mem_phase_results(struct mem_phase_result* out, size_t max) {
+  for (size_t i = 0; i < g_num_phases && i < max; ++i) {
+    out[i] = g_phases[i];
+  }
+  return g_num_phases;
+}
+
+void mem_phases_log() {
+  for (size_t i = 0; i < g_num_phases; ++i) {
+    const struct mem_phase_result& p = g_phases[i];
+    log(INFO, "mem %s: calls=%llu start=%.1f MiB end=%.1f MiB peak=%.1f MiB",
+        p.name, static_cast<unsigned long long>(p.calls),
+        p.start_bytes / 1048576.0, p.end_bytes / 1048576.0,
+        p.peak_bytes / 1048576.0);
+  }
+}
+
+void mem_phases_reset() { g_num_phases = 0; }
+
+}  // namespace proofs
+
+#if defined(PROOFS_MEM_ACCOUNTING)
+// Every block carries a header of max(alignment, 16) bytes whose last 16
+// bytes hold the requested size, so frees can be accounted without asking
+// the C library.
+namespace {
+
+constexpr size_t kHeader = 16;
+
+void* accounted_alloc(size_t size, size_t align) {
+  size_t hdr = align > kHeader ? align : kHeader;
+  // Covers the header and the round-up below; new T[n] passes SIZE_MAX
+  // when n * sizeof(T) overflows.
+  if (size > SIZE_MAX - hdr - align) return nullptr;
+  void* base;
+  if (align > kHeader) {
+    size_t total = (hdr + size + align - 1) & ~(align - 1);
+    base = aligned_alloc(align, total);
+  } else {
+    base = malloc(hdr + size);
+  }
+  if (base == nullptr) return nullptr;
+  char* p = static_cast<char*>(base) + hdr;
+  memcpy(p - kHeader, &size, sizeof(size));
+  proofs::mem_account_alloc(size);
+  return p;
+}
+
+void accounted_free(void* ptr, size_t align) {
+  if (ptr == nullptr) return;
+  size_t hdr = align > kHeader ? align : kHeader;
+  char* p = static_cast<char*>(ptr);
+  size_t size;
+  memcpy(&size, p - kHeader, sizeof(size));
+  proofs::mem_account_free(size);
+  free(p - hdr);
+}
+
+void* accounted_new(size_t size, size_t align) {
+  void* p = accounted_alloc(size, align);
+  if (p == nullptr) {
+#if defined(__cpp_exceptions)
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  return p;
+}
+
+}  // namespace
+
+void* operator new(size_t n) { return accounted_new(n, 0); }
+void* operator new[](size_t n) { return accounted_new(n, 0); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+  return accounted_alloc(n, 0);
+}
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+  return accounted_alloc(n, 0);
+}
+void* operator new(size_t n, std::align_val_t a) {
+  return accounted_new(n, static_cast<size_t>(a));
+}
+void* operator new[](size_t n, std::align_val_t a) {
+  return accounted_new(n, static_cast<size_t>(a));
+}
+void* operator new(size_t n, std::align_val_t a,
+                   const std::nothrow_t&) noexcept {
+  return accounted_alloc(n, static_cast<size_t>(a));
+}
+void* operator new[](size_t n, std::align_val_t a,
+                     const std::nothrow_t&) noexcept {
+  return accounted_alloc(n, static_cast<size_t>(a));
+}
+
+void operator delete(void* p) noexcept { accounted_free(p, 0); }
+void operator delete[](void* p) noexcept { accounted_free(p, 0); }
+void operator delete(void* p, size_t) noexcept { accounted_free(p, 0); }
+void operator delete[](void* p, size_t) noexcept { accounted_free(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  accounted_free(p, 0);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  accounted_free(p, 0);
+}
+void operator delete(void* p, std::align_val_t a) noexcept {
+  accounted_free(p, static_cast<size_t>(a));
+}
+void operator delete[](void* p, std::align_val_t a) noexcept {
+  accounted_free(p, static_cast<size_t>(a));
+}
+void operator delete(void* p, size_t, std::align_val_t a) noexcept {
+  accounted_free(p, static_cast<size_t>(a));
+}
+void operator delete[](void* p, size_t, std::align_val_t a) noexcept {
+  accounted_free(p, static_cast<size_t>(a));
+}
+void operator delete(void* p, std::align_val_t a,
+                     const std::nothrow_t&) noexcept {
+  accounted_free(p, static_cast<size_t>(a));
+}
+void operator delete[](void* p, std::align_val_t a,
+                       const std::nothrow_t&) noexcept {
+  accounted_free(p, static_cast<size_t>(a));
+}
+#endif  // PROOFS_MEM_ACCOUNTING
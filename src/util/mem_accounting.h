@@ -0,0 +1,97 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_UTIL_MEM_ACCOUNTING_H_
+#define PRIVACY_PROOFS_ZK_LIB_UTIL_MEM_ACCOUNTING_H_
+
+// Opt-in heap accounting with per-phase high-water marks.
+//
+// Building the library with -DPROOFS_MEM_ACCOUNTING replaces the global
+// operator new/delete with versions that keep a small size header and
+// count live bytes.  Allocators that bypass operator new can report
+// through mem_account_alloc()/mem_account_free().  Without the flag the
+// API still links, but only explicitly reported bytes are counted.
+//
+// Counters are global and atomic, so allocations from any thread are
+// seen.  Phases form a stack and should be entered and left on one
+// thread at a time.
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" {
+
+struct mem_phase_result {
+  const char* name;
+  uint64_t calls;
+  uint64_t start_bytes;  // live bytes when the phase was last entered
+  uint64_t end_bytes;    // live bytes when the phase was last left
+  uint64_t peak_bytes;   // highest live bytes seen inside any call
+};
+
+}  // extern "C"
+
+namespace proofs {
+
+// True if the library was built with operator new/delete accounting.
+bool mem_accounting_available();
+
+uint64_t mem_current_bytes();
+uint64_t mem_peak_bytes();
+
+// Hooks for allocators that do not go through operator new.
+void mem_account_alloc(size_t bytes);
+void mem_account_free(size_t bytes);
+
+// Records live and peak heap bytes over its lifetime under NAME, which
+// must outlive the results (normally a string literal).
+class MemPhase {
+ public:
+  explicit MemPhase(const char* name);
+  ~MemPhase();
+
+  MemPhase(const MemPhase&) = delete;
+  MemPhase& operator=(const MemPhase&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_;
+  uint64_t saved_peak_;
+};
+
+// Copies up to MAX phase results, in the order the phases first completed,
+// to OUT and returns the number of phases recorded.
+size_t mem_phase_results(struct mem_phase_result* out, size_t max);
+
+// Logs one INFO line per phase.
+void mem_phases_log();
+
+void mem_phases_reset();
+
+}  // namespace proofs
+
+#define PROOFS_MEM_CONCAT_(a, b) a##b
+#define PROOFS_MEM_CONCAT(a, b) PROOFS_MEM_CONCAT_(a, b)
+
+// Accounts the rest of the enclosing scope under NAME.
+#define PROOFS_MEM_PHASE(name) \
+  ::proofs::MemPhase PROOFS_MEM_CONCAT(proofs_mem_phase_, __LINE__)(name)
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_UTIL_MEM_ACCOUNTING_H_
@@ -0,0 +1,262 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "util/perf_counters.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "util/log.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PROOFS_HAVE_PERF_EVENT 1
+#endif
+
+namespace proofs {
+
+namespace {
+
+constexpr size_t kMaxPhases = 64;
+constexpr size_t kNumCounters = 5;
+
+struct PhaseSlot {
+  const char* name;
+  uint64_t calls;
+  struct perf_counter_values totals;
+};
+
+// Written only by the thread that owns the counters (see g_owner).
+PhaseSlot g_phases[kMaxPhases];
+size_t g_num_phases = 0;
+
+struct CounterGroup {
+  int leader = -1;
+  int fds[kNumCounters] = {-1, -1, -1, -1, -1};
+  // Position of each counter in the group read, or -1 if not opened.
+  int slot[kNumCounters] = {-1, -1, -1, -1, -1};
+  int opened = 0;
+  uint32_t valid = 0;
+};
+
+thread_local CounterGroup t_group;
+
+// The t_group of the one thread with counters enabled, or null.  PerfPhase
+// does nothing on threads without an open group, so only the owner ever
+// records into g_phases.
+std::atomic<const CounterGroup*> g_owner{nullptr};
+
+uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+#if defined(PROOFS_HAVE_PERF_EVENT)
+struct CounterSpec {
+  uint32_t type;
+  uint64_t config;
+};
+
+const CounterSpec kCounters[kNumCounters] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int open_counter(const CounterSpec& c, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = c.type;
+  attr.config = c.config;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1, group_fd,
+              0));
+}
+#endif
+
+// Reads the current counter values; fields without a counter stay zero.
+// *ENABLED and *RUNNING receive the group's total enabled and scheduled
+// times, which differ once the PMU multiplexes the group.
+void read_counters(struct perf_counter_values* v, uint64_t* enabled,
+                   uint64_t* running) {
+  memset(v, 0, sizeof(*v));
+  *enabled = *running = 0;
+  v->wall_ns = now_ns();
+#if defined(PROOFS_HAVE_PERF_EVENT)
+  const CounterGroup& g = t_group;
+  // { nr, time_enabled, time_running, value[nr] }
+  uint64_t buf[3 + kNumCounters];
+  if (read(g.leader, buf, sizeof(buf)) <
+      static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+    return;
+  }
+  *enabled = buf[1];
+  *running = buf[2];
+  uint64_t* dst[kNumCounters] = {&v->cycles, &v->instructions,
+                                 &v->l1d_misses, &v->llc_misses,
+                                 &v->branch_misses};
+  for (size_t i = 0; i < kNumCounters; ++i) {
+    if (g.slot[i] >= 0 && static_cast<uint64_t>(g.slot[i]) < buf[0]) {
+      *dst[i] = buf[3 + g.slot[i]];
+    }
+  }
+  v->valid = g.valid;
+#endif
+}
+
+PhaseSlot* find_phase(const char* name) {
+  for (size_t i = 0; i < g_num_phases; ++i) {
+    if (g_phases[i].name == name || strcmp(g_phases[i].name, name) == 0) {
+      return &g_phases[i];
+    }
+  }
+  if (g_num_phases == kMaxPhases) return nullptr;
+  PhaseSlot* p = &g_phases[g_num_phases++];
+  memset(p, 0, sizeof(*p));
+  p->name = name;
+  return p;
+}
+
+}  // namespace
+
+bool perf_counters_enable() {
+#if defined(PROOFS_HAVE_PERF_EVENT)
+  CounterGroup& g = t_group;
+  if (g.leader >= 0) return true;
+  const CounterGroup* expected = nullptr;
+  if (!g_owner.compare_exchange_strong(expected, &g)) {
+    log(WARNING, "hardware counters are already enabled on another thread");
+    return false;
+  }
+  for (size_t i = 0; i < kNumCounters; ++i) {
+    int fd = open_counter(kCounters[i], g.leader);
+    if (fd < 0) continue;
+    if (g.leader < 0) g.leader = fd;
+    g.fds[i] = fd;
+    g.slot[i] = g.opened++;
+    g.valid |= 1u << i;
+  }
+  if (g.leader < 0) {
+    g_owner.store(nullptr);
+    log(WARNING, "perf_event_open failed; hardware counters unavailable");
+    return false;
+  }
+  ioctl(g.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(g.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void perf_counters_disable() {
+#if defined(PROOFS_HAVE_PERF_EVENT)
+  CounterGroup& g = t_group;
+  if (g.leader < 0) return;
+  for (size_t i = 0; i < kNumCounters; ++i) {
+    if (g.fds[i] >= 0) close(g.fds[i]);
+  }
+  g = CounterGroup();
+  g_owner.store(nullptr);
+#endif
+}
+
+PerfPhase::PerfPhase(const char* name) : name_(nullptr) {
+  if (t_group.leader >= 0) {
+    name_ = name;
+    read_counters(&start_, &start_enabled_, &start_running_);
+  }
+}
+
+PerfPhase::~PerfPhase() {
+  if (name_ == nullptr || t_group.leader < 0) return;
+  struct perf_counter_values end;
+  uint64_t enabled, running;
+  read_counters(&end, &enabled, &running);
+  // Counts of a group that was not on the PMU for the whole phase are
+  // partial (or all zero); report them as missing rather than scaled.
+  if (running - start_running_ < enabled - start_enabled_) end.valid = 0;
+  PhaseSlot* p = find_phase(name_);
+  if (p == nullptr) return;
+  p->calls++;
+  p->totals.cycles += end.cycles - start_.cycles;
+  p->totals.instructions += end.instructions - start_.instructions;
+  p->totals.l1d_misses += end.l1d_misses - start_.l1d_misses;
+  p->totals.llc_misses += end.llc_misses - start_.llc_misses;
+  p->totals.branch_misses += end.branch_misses - start_.branch_misses;
+  p->totals.wall_ns += end.wall_ns - start_.wall_ns;
+  // A phase is only as valid as its least valid call.
+  p->totals.valid = p->calls == 1 ? end.valid : p->totals.valid & end.valid;
+}
+
+size_t perf_phase_results(struct perf_phase_result* out, size_t max) {
+  for (size_t i = 0; i < g_num_phases && i < max; ++i) {
+    out[i].name = g_phases[i].name;
+    out[i].calls = g_phases[i].calls;
+    out[i].totals = g_phases[i].totals;
+  }
+  return g_num_phases;
+}
+
+void perf_phases_log() {
+  for (size_t i = 0; i < g_num_phases; ++i) {
+    const struct perf_counter_values& v = g_phases[i].totals;
+    const uint32_t kCore = PERF_COUNTER_CYCLES | PERF_COUNTER_INSTRUCTIONS;
+    if ((v.valid & kCore) != kCore) {
+      log(INFO, "perf %s: calls=%llu wall=%.3f ms counters unavailable",
+          g_phases[i].name,
+          static_cast<unsigned long long>(g_phases[i].calls), v.wall_ns / 1e6);
+      continue;
+    }
+    double ipc = v.cycles ? static_cast<double>(v.instructions) / v.cycles : 0;
+    double kinstr = v.instructions / 1000.0;
+    log(INFO,
+        "perf %s: calls=%llu wall=%.3f ms cycles=%llu instr=%llu ipc=%.2f "
+        "l1d-mpki=%.2f llc-mpki=%.2f br-mpki=%.2f",
+        g_phases[i].name, static_cast<unsigned long long>(g_phases[i].calls),
+        v.wall_ns / 1e6, static_cast<unsigned long long>(v.cycles),
+        static_cast<unsigned long long>(v.instructions), ipc,
+        kinstr > 0 ? v.l1d_misses / kinstr : 0,
+        kinstr > 0 ? v.llc_misses / kinstr : 0,
+        kinstr > 0 ? v.branch_misses / kinstr : 0);
+  }
+}
+
+void perf_phases_reset() { g_num_phases = 0; }
+
+}  // namespace proofs
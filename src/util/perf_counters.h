@@ -0,0 +1,111 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_UTIL_PERF_COUNTERS_H_
+#define PRIVACY_PROOFS_ZK_LIB_UTIL_PERF_COUNTERS_H_
+
+// Hardware performance counters per named phase, via Linux
+// perf_event_open(2).  Counters cover user-space execution of the thread
+// that called perf_counters_enable(); PerfPhase scopes on other threads,
+// or when counters are unavailable (other OSes, wasm, a restrictive
+// perf_event_paranoid), cost a thread-local check and record nothing.
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" {
+
+// Bits of perf_counter_values.valid: which counters the kernel provided
+// and kept scheduled for the whole phase.  A group the PMU multiplexed or
+// never scheduled has valid == 0.
+#define PERF_COUNTER_CYCLES (1u << 0)
+#define PERF_COUNTER_INSTRUCTIONS (1u << 1)
+#define PERF_COUNTER_L1D_MISSES (1u << 2)
+#define PERF_COUNTER_LLC_MISSES (1u << 3)
+#define PERF_COUNTER_BRANCH_MISSES (1u << 4)
+
+struct perf_counter_values {
+  uint64_t cycles;
+  uint64_t instructions;
+  uint64_t l1d_misses;    // L1 data cache read misses
+  uint64_t llc_misses;    // last-level cache misses
+  uint64_t branch_misses;
+  uint64_t wall_ns;
+  uint32_t valid;         // PERF_COUNTER_* bits
+};
+
+struct perf_phase_result {
+  const char* name;
+  uint64_t calls;
+  struct perf_counter_values totals;
+};
+
+}  // extern "C"
+
+namespace proofs {
+
+// Opens the counters for the calling thread.  Only one thread at a time
+// may have counters enabled; returns false if another thread does, or if
+// none could be opened.  Phases are then not recorded.
+bool perf_counters_enable();
+// Closes the calling thread's counters, letting another thread enable them.
+void perf_counters_disable();
+
+// Accumulates the counter deltas of its lifetime into the phase NAME.
+// NAME must outlive the results (normally a string literal).  Phases may
+// nest; each one includes the cost of its children.
+class PerfPhase {
+ public:
+  explicit PerfPhase(const char* name);
+  ~PerfPhase();
+
+  PerfPhase(const PerfPhase&) = delete;
+  PerfPhase& operator=(const PerfPhase&) = delete;
+
+ private:
+  const char* name_;
+  struct perf_counter_values start_;
+  uint64_t start_enabled_;
+  uint64_t start_running_;
+};
+
+// The results below are read without synchronization: call them on the
+// thread that enabled the counters, or once it no longer records phases.
+//
+// Copies up to MAX phase results, in the order the phases first completed,
+// to OUT and returns the number of phases recorded.
+size_t perf_phase_results(struct perf_phase_result* out, size_t max);
+
+// Logs one INFO line per phase with IPC and miss rates, or only the wall
+// time for phases whose counters are not valid.
+void perf_phases_log();
+
+void perf_phases_reset();
+
+}  // namespace proofs
+
+#define PROOFS_PERF_CONCAT_(a, b) a##b
+#define PROOFS_PERF_CONCAT(a, b) PROOFS_PERF_CONCAT_(a, b)
+
+// Counts the rest of the enclosing scope under NAME.
+#define PROOFS_PERF_PHASE(name) \
+  ::proofs::PerfPhase PROOFS_PERF_CONCAT(proofs_perf_phase_, __LINE__)(name)
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_UTIL_PERF_COUNTERS_H_
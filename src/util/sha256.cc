@@ -10,7 +10,15 @@
 #include <stdlib.h>
 
 #include "sha256.h"
-#define SHA256CTX_BYTES 40
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
 
 static uint32_t load_bigendian_32(const uint8_t *x) {
     return (uint32_t)(x[3]) | (((uint32_t)(x[2])) << 8) |
@@ -27,31 +35,6 @@ static void store_bigendian_32(uint8_t *x, uint64_t u) {
     x[0] = (uint8_t) u;
 }
 
-static uint64_t load_bigendian_64(const uint8_t *x) {
-    return (uint64_t)(x[7]) | (((uint64_t)(x[6])) << 8) |
-           (((uint64_t)(x[5])) << 16) | (((uint64_t)(x[4])) << 24) |
-           (((uint64_t)(x[3])) << 32) | (((uint64_t)(x[2])) << 40) |
-           (((uint64_t)(x[1])) << 48) | (((uint64_t)(x[0])) << 56);
-}
-
-static void store_bigendian_64(uint8_t *x, uint64_t u) {
-    x[7] = (uint8_t) u;
-    u >>= 8;
-    x[6] = (uint8_t) u;
-    u >>= 8;
-    x[5] = (uint8_t) u;
-    u >>= 8;
-    x[4] = (uint8_t) u;
-    u >>= 8;
-    x[3] = (uint8_t) u;
-    u >>= 8;
-    x[2] = (uint8_t) u;
-    u >>= 8;
-    x[1] = (uint8_t) u;
-    u >>= 8;
-    x[0] = (uint8_t) u;
-}
-
 #define SHR(x, c) ((x) >> (c))
 #define ROTR_32(x, c) (((x) >> (c)) | ((x) << (32 - (c))))
 
@@ -95,9 +78,77 @@ static void store_bigendian_64(uint8_t *x, uint64_t u) {
     b = a;                                           \
     a = T1 + T2;
 
-static size_t crypto_hashblocks_sha256(uint8_t *statebytes,
-                                       const uint8_t *in, size_t inlen) {
-    uint32_t state[8];
+#define ROUNDS_32           \
+    F_32(w0, 0x428a2f98)    \
+    F_32(w1, 0x71374491)    \
+    F_32(w2, 0xb5c0fbcf)    \
+    F_32(w3, 0xe9b5dba5)    \
+    F_32(w4, 0x3956c25b)    \
+    F_32(w5, 0x59f111f1)    \
+    F_32(w6, 0x923f82a4)    \
+    F_32(w7, 0xab1c5ed5)    \
+    F_32(w8, 0xd807aa98)    \
+    F_32(w9, 0x12835b01)    \
+    F_32(w10, 0x243185be)   \
+    F_32(w11, 0x550c7dc3)   \
+    F_32(w12, 0x72be5d74)   \
+    F_32(w13, 0x80deb1fe)   \
+    F_32(w14, 0x9bdc06a7)   \
+    F_32(w15, 0xc19bf174)   \
+    EXPAND_32               \
+    F_32(w0, 0xe49b69c1)    \
+    F_32(w1, 0xefbe4786)    \
+    F_32(w2, 0x0fc19dc6)    \
+    F_32(w3, 0x240ca1cc)    \
+    F_32(w4, 0x2de92c6f)    \
+    F_32(w5, 0x4a7484aa)    \
+    F_32(w6, 0x5cb0a9dc)    \
+    F_32(w7, 0x76f988da)    \
+    F_32(w8, 0x983e5152)    \
+    F_32(w9, 0xa831c66d)    \
+    F_32(w10, 0xb00327c8)   \
+    F_32(w11, 0xbf597fc7)   \
+    F_32(w12, 0xc6e00bf3)   \
+    F_32(w13, 0xd5a79147)   \
+    F_32(w14, 0x06ca6351)   \
+    F_32(w15, 0x14292967)   \
+    EXPAND_32               \
+    F_32(w0, 0x27b70a85)    \
+    F_32(w1, 0x2e1b2138)    \
+    F_32(w2, 0x4d2c6dfc)    \
+    F_32(w3, 0x53380d13)    \
+    F_32(w4, 0x650a7354)    \
+    F_32(w5, 0x766a0abb)    \
+    F_32(w6, 0x81c2c92e)    \
+    F_32(w7, 0x92722c85)    \
+    F_32(w8, 0xa2bfe8a1)    \
+    F_32(w9, 0xa81a664b)    \
+    F_32(w10, 0xc24b8b70)   \
+    F_32(w11, 0xc76c51a3)   \
+    F_32(w12, 0xd192e819)   \
+    F_32(w13, 0xd6990624)   \
+    F_32(w14, 0xf40e3585)   \
+    F_32(w15, 0x106aa070)   \
+    EXPAND_32               \
+    F_32(w0, 0x19a4c116)    \
+    F_32(w1, 0x1e376c08)    \
+    F_32(w2, 0x2748774c)    \
+    F_32(w3, 0x34b0bcb5)    \
+    F_32(w4, 0x391c0cb3)    \
+    F_32(w5, 0x4ed8aa4a)    \
+    F_32(w6, 0x5b9cca4f)    \
+    F_32(w7, 0x682e6ff3)    \
+    F_32(w8, 0x748f82ee)    \
+    F_32(w9, 0x78a5636f)    \
+    F_32(w10, 0x84c87814)   \
+    F_32(w11, 0x8cc70208)   \
+    F_32(w12, 0x90befffa)   \
+    F_32(w13, 0xa4506ceb)   \
+    F_32(w14, 0xbef9a3f7)   \
+    F_32(w15, 0xc67178f2)
+
+static size_t crypto_hashblocks_sha256_ref(uint32_t *state,
+                                           const uint8_t *in, size_t inlen) {
     uint32_t a;
     uint32_t b;
     uint32_t c;
@@ -109,22 +160,14 @@ static size_t crypto_hashblocks_sha256(uint8_t *statebytes,
     uint32_t T1;
     uint32_t T2;
 
-    a = load_bigendian_32(statebytes + 0);
-    state[0] = a;
-    b = load_bigendian_32(statebytes + 4);
-    state[1] = b;
-    c = load_bigendian_32(statebytes + 8);
-    state[2] = c;
-    d = load_bigendian_32(statebytes + 12);
-    state[3] = d;
-    e = load_bigendian_32(statebytes + 16);
-    state[4] = e;
-    f = load_bigendian_32(statebytes + 20);
-    state[5] = f;
-    g = load_bigendian_32(statebytes + 24);
-    state[6] = g;
-    h = load_bigendian_32(statebytes + 28);
-    state[7] = h;
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+    f = state[5];
+    g = state[6];
+    h = state[7];
 
     while (inlen >= 64) {
         uint32_t w0  = load_bigendian_32(in + 0);
@@ -144,79 +187,7 @@ static size_t crypto_hashblocks_sha256(uint8_t *statebytes,
         uint32_t w14 = load_bigendian_32(in + 56);
         uint32_t w15 = load_bigendian_32(in + 60);
 
-        F_32(w0, 0x428a2f98)
-        F_32(w1, 0x71374491)
-        F_32(w2, 0xb5c0fbcf)
-        F_32(w3, 0xe9b5dba5)
-        F_32(w4, 0x3956c25b)
-        F_32(w5, 0x59f111f1)
-        F_32(w6, 0x923f82a4)
-        F_32(w7, 0xab1c5ed5)
-        F_32(w8, 0xd807aa98)
-        F_32(w9, 0x12835b01)
-        F_32(w10, 0x243185be)
-        F_32(w11, 0x550c7dc3)
-        F_32(w12, 0x72be5d74)
-        F_32(w13, 0x80deb1fe)
-        F_32(w14, 0x9bdc06a7)
-        F_32(w15, 0xc19bf174)
-
-        EXPAND_32
-
-        F_32(w0, 0xe49b69c1)
-        F_32(w1, 0xefbe4786)
-        F_32(w2, 0x0fc19dc6)
-        F_32(w3, 0x240ca1cc)
-        F_32(w4, 0x2de92c6f)
-        F_32(w5, 0x4a7484aa)
-        F_32(w6, 0x5cb0a9dc)
-        F_32(w7, 0x76f988da)
-        F_32(w8, 0x983e5152)
-        F_32(w9, 0xa831c66d)
-        F_32(w10, 0xb00327c8)
-        F_32(w11, 0xbf597fc7)
-        F_32(w12, 0xc6e00bf3)
-        F_32(w13, 0xd5a79147)
-        F_32(w14, 0x06ca6351)
-        F_32(w15, 0x14292967)
-
-        EXPAND_32
-
-        F_32(w0, 0x27b70a85)
-        F_32(w1, 0x2e1b2138)
-        F_32(w2, 0x4d2c6dfc)
-        F_32(w3, 0x53380d13)
-        F_32(w4, 0x650a7354)
-        F_32(w5, 0x766a0abb)
-        F_32(w6, 0x81c2c92e)
-        F_32(w7, 0x92722c85)
-        F_32(w8, 0xa2bfe8a1)
-        F_32(w9, 0xa81a664b)
-        F_32(w10, 0xc24b8b70)
-        F_32(w11, 0xc76c51a3)
-        F_32(w12, 0xd192e819)
-        F_32(w13, 0xd6990624)
-        F_32(w14, 0xf40e3585)
-        F_32(w15, 0x106aa070)
-
-        EXPAND_32
-
-        F_32(w0, 0x19a4c116)
-        F_32(w1, 0x1e376c08)
-        F_32(w2, 0x2748774c)
-        F_32(w3, 0x34b0bcb5)
-        F_32(w4, 0x391c0cb3)
-        F_32(w5, 0x4ed8aa4a)
-        F_32(w6, 0x5b9cca4f)
-        F_32(w7, 0x682e6ff3)
-        F_32(w8, 0x748f82ee)
-        F_32(w9, 0x78a5636f)
-        F_32(w10, 0x84c87814)
-        F_32(w11, 0x8cc70208)
-        F_32(w12, 0x90befffa)
-        F_32(w13, 0xa4506ceb)
-        F_32(w14, 0xbef9a3f7)
-        F_32(w15, 0xc67178f2)
+        ROUNDS_32
 
         a += state[0];
         b += state[1];
@@ -240,105 +211,702 @@ static size_t crypto_hashblocks_sha256(uint8_t *statebytes,
         inlen -= 64;
     }
 
-    store_bigendian_32(statebytes + 0, state[0]);
-    store_bigendian_32(statebytes + 4, state[1]);
-    store_bigendian_32(statebytes + 8, state[2]);
-    store_bigendian_32(statebytes + 12, state[3]);
-    store_bigendian_32(statebytes + 16, state[4]);
-    store_bigendian_32(statebytes + 20, state[5]);
-    store_bigendian_32(statebytes + 24, state[6]);
-    store_bigendian_32(statebytes + 28, state[7]);
+    return inlen;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/* Block compression with the x86 SHA extensions.  The state is kept in the
+   ABEF/CDGH register layout expected by sha256rnds2; each quad round
+   consumes four schedule words and extends the schedule four words ahead
+   with sha256msg1/sha256msg2. */
+
+#define SHANI_RNDS(m, k1, k0)                                         \
+    msg = _mm_add_epi32(m, _mm_set_epi64x(k1, k0));                   \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);              \
+    msg = _mm_shuffle_epi32(msg, 0x0E);                               \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+#define SHANI_MSG1(m0, m1) m0 = _mm_sha256msg1_epu32(m0, m1);
+
+#define SHANI_MSG2(mnext, mcur, mprev)                                \
+    tmp = _mm_alignr_epi8(mcur, mprev, 4);                            \
+    mnext = _mm_add_epi32(mnext, tmp);                                \
+    mnext = _mm_sha256msg2_epu32(mnext, mcur);
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static size_t crypto_hashblocks_sha256_shani(uint32_t *state,
+                                             const uint8_t *in, size_t inlen) {
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                         0x0405060700010203ULL);
+    __m128i state0, state1, abef, cdgh, msg, tmp;
+    __m128i m0, m1, m2, m3;
+
+    tmp = _mm_loadu_si128((const __m128i *) &state[0]);    /* DCBA */
+    state1 = _mm_loadu_si128((const __m128i *) &state[4]); /* HGFE */
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                     /* CDAB */
+    state1 = _mm_shuffle_epi32(state1, 0x1B);               /* EFGH */
+    state0 = _mm_alignr_epi8(tmp, state1, 8);               /* ABEF */
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);            /* CDGH */
+
+    while (inlen >= 64) {
+        abef = state0;
+        cdgh = state1;
+
+        m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 0)), bswap);
+        m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 16)), bswap);
+        m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 32)), bswap);
+        m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 48)), bswap);
+
+        SHANI_RNDS(m0, 0xE9B5DBA5B5C0FBCFULL, 0x71374491428A2F98ULL)
+        SHANI_RNDS(m1, 0xAB1C5ED5923F82A4ULL, 0x59F111F13956C25BULL)
+        SHANI_MSG1(m0, m1)
+        SHANI_RNDS(m2, 0x550C7DC3243185BEULL, 0x12835B01D807AA98ULL)
+        SHANI_MSG1(m1, m2)
+        SHANI_RNDS(m3, 0xC19BF1749BDC06A7ULL, 0x80DEB1FE72BE5D74ULL)
+        SHANI_MSG2(m0, m3, m2)
+        SHANI_MSG1(m2, m3)
+        SHANI_RNDS(m0, 0x240CA1CC0FC19DC6ULL, 0xEFBE4786E49B69C1ULL)
+        SHANI_MSG2(m1, m0, m3)
+        SHANI_MSG1(m3, m0)
+        SHANI_RNDS(m1, 0x76F988DA5CB0A9DCULL, 0x4A7484AA2DE92C6FULL)
+        SHANI_MSG2(m2, m1, m0)
+        SHANI_MSG1(m0, m1)
+        SHANI_RNDS(m2, 0xBF597FC7B00327C8ULL, 0xA831C66D983E5152ULL)
+        SHANI_MSG2(m3, m2, m1)
+        SHANI_MSG1(m1, m2)
+        SHANI_RNDS(m3, 0x1429296706CA6351ULL, 0xD5A79147C6E00BF3ULL)
+        SHANI_MSG2(m0, m3, m2)
+        SHANI_MSG1(m2, m3)
+        SHANI_RNDS(m0, 0x53380D134D2C6DFCULL, 0x2E1B213827B70A85ULL)
+        SHANI_MSG2(m1, m0, m3)
+        SHANI_MSG1(m3, m0)
+        SHANI_RNDS(m1, 0x92722C8581C2C92EULL, 0x766A0ABB650A7354ULL)
+        SHANI_MSG2(m2, m1, m0)
+        SHANI_MSG1(m0, m1)
+        SHANI_RNDS(m2, 0xC76C51A3C24B8B70ULL, 0xA81A664BA2BFE8A1ULL)
+        SHANI_MSG2(m3, m2, m1)
+        SHANI_MSG1(m1, m2)
+        SHANI_RNDS(m3, 0x106AA070F40E3585ULL, 0xD6990624D192E819ULL)
+        SHANI_MSG2(m0, m3, m2)
+        SHANI_MSG1(m2, m3)
+        SHANI_RNDS(m0, 0x34B0BCB52748774CULL, 0x1E376C0819A4C116ULL)
+        SHANI_MSG2(m1, m0, m3)
+        SHANI_MSG1(m3, m0)
+        SHANI_RNDS(m1, 0x682E6FF35B9CCA4FULL, 0x4ED8AA4A391C0CB3ULL)
+        SHANI_MSG2(m2, m1, m0)
+        SHANI_RNDS(m2, 0x8CC7020884C87814ULL, 0x78A5636F748F82EEULL)
+        SHANI_MSG2(m3, m2, m1)
+        SHANI_RNDS(m3, 0xC67178F2BEF9A3F7ULL, 0xA4506CEB90BEFFFAULL)
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+
+        in += 64;
+        inlen -= 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);                  /* FEBA */
+    state1 = _mm_shuffle_epi32(state1, 0xB1);               /* DCHG */
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);            /* DCBA */
+    state1 = _mm_alignr_epi8(state1, tmp, 8);               /* HGFE */
+    _mm_storeu_si128((__m128i *) &state[0], state0);
+    _mm_storeu_si128((__m128i *) &state[4], state1);
 
     return inlen;
 }
 
-static const uint8_t iv_256[32] = {
-    0x6a, 0x09, 0xe6, 0x67, 0xbb, 0x67, 0xae, 0x85,
-    0x3c, 0x6e, 0xf3, 0x72, 0xa5, 0x4f, 0xf5, 0x3a,
-    0x51, 0x0e, 0x52, 0x7f, 0x9b, 0x05, 0x68, 0x8c,
-    0x1f, 0x83, 0xd9, 0xab, 0x5b, 0xe0, 0xcd, 0x19
+#undef SHANI_RNDS
+#undef SHANI_MSG1
+#undef SHANI_MSG2
+#endif
+
+#if defined(__aarch64__)
+/* Block compression with the ARMv8 Cryptography Extensions.  The state is
+   kept as {a,b,c,d} / {e,f,g,h}; each quad round feeds W[t]+K[t] to
+   sha256h/sha256h2 while sha256su0/sha256su1 extend the schedule. */
+
+#if defined(__ARM_FEATURE_SHA2)
+#define ARMV8_SHA2_TARGET
+#elif defined(__clang__)
+#define ARMV8_SHA2_TARGET __attribute__((target("crypto")))
+#else
+#define ARMV8_SHA2_TARGET __attribute__((target("+crypto")))
+#endif
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
-void sha256_inc_init(sha256ctx *state) {
-    for (size_t i = 0; i < 32; ++i) {
-        state->ctx[i] = iv_256[i];
+#define ARMV8_RNDS(m, t)                                              \
+    wk = vaddq_u32(m, vld1q_u32(sha256_k + (t)));                     \
+    tmp = state0;                                                     \
+    state0 = vsha256hq_u32(state0, state1, wk);                       \
+    state1 = vsha256h2q_u32(state1, tmp, wk);
+
+#define ARMV8_RNDS_EXPAND(m0, m1, m2, m3, t)                          \
+    wk = vaddq_u32(m0, vld1q_u32(sha256_k + (t)));                    \
+    m0 = vsha256su0q_u32(m0, m1);                                     \
+    tmp = state0;                                                     \
+    state0 = vsha256hq_u32(state0, state1, wk);                       \
+    state1 = vsha256h2q_u32(state1, tmp, wk);                         \
+    m0 = vsha256su1q_u32(m0, m2, m3);
+
+ARMV8_SHA2_TARGET
+static size_t crypto_hashblocks_sha256_armv8(uint32_t *state,
+                                             const uint8_t *in, size_t inlen) {
+    uint32x4_t state0, state1, abcd, efgh, wk, tmp;
+    uint32x4_t m0, m1, m2, m3;
+
+    state0 = vld1q_u32(&state[0]);
+    state1 = vld1q_u32(&state[4]);
+
+    while (inlen >= 64) {
+        abcd = state0;
+        efgh = state1;
+
+        m0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(in + 0)));
+        m1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(in + 16)));
+        m2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(in + 32)));
+        m3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(in + 48)));
+
+        ARMV8_RNDS_EXPAND(m0, m1, m2, m3, 0)
+        ARMV8_RNDS_EXPAND(m1, m2, m3, m0, 4)
+        ARMV8_RNDS_EXPAND(m2, m3, m0, m1, 8)
+        ARMV8_RNDS_EXPAND(m3, m0, m1, m2, 12)
+        ARMV8_RNDS_EXPAND(m0, m1, m2, m3, 16)
+        ARMV8_RNDS_EXPAND(m1, m2, m3, m0, 20)
+        ARMV8_RNDS_EXPAND(m2, m3, m0, m1, 24)
+        ARMV8_RNDS_EXPAND(m3, m0, m1, m2, 28)
+        ARMV8_RNDS_EXPAND(m0, m1, m2, m3, 32)
+        ARMV8_RNDS_EXPAND(m1, m2, m3, m0, 36)
+        ARMV8_RNDS_EXPAND(m2, m3, m0, m1, 40)
+        ARMV8_RNDS_EXPAND(m3, m0, m1, m2, 44)
+        ARMV8_RNDS(m0, 48)
+        ARMV8_RNDS(m1, 52)
+        ARMV8_RNDS(m2, 56)
+        ARMV8_RNDS(m3, 60)
+
+        state0 = vaddq_u32(state0, abcd);
+        state1 = vaddq_u32(state1, efgh);
+
+        in += 64;
+        inlen -= 64;
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+
+    return inlen;
+}
+
+#undef ARMV8_RNDS
+#undef ARMV8_RNDS_EXPAND
+#endif
+
+typedef size_t (*hashblocks_fn)(uint32_t *state, const uint8_t *in,
+                                size_t inlen);
+
+/* Pick the fastest block function supported by the host CPU. */
+static hashblocks_fn crypto_hashblocks_sha256_select(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_FEATURE_SHA | CPU_FEATURE_SSE41 | CPU_FEATURE_SSSE3)) {
+        return crypto_hashblocks_sha256_shani;
     }
-    for (size_t i = 32; i < 40; ++i) {
-        state->ctx[i] = 0;
+#elif defined(__aarch64__)
+    if (cpu_has(CPU_FEATURE_ARM_SHA2)) {
+        return crypto_hashblocks_sha256_armv8;
     }
+#endif
+    return crypto_hashblocks_sha256_ref;
 }
 
-void sha256_inc_ctx_clone(sha256ctx *stateout, const sha256ctx *statein) {
-    for (size_t i = 0; i < SHA256CTX_BYTES; ++i) {
-        stateout->ctx[i] = statein->ctx[i];
+static hashblocks_fn crypto_hashblocks_sha256_impl(void) {
+    static const hashblocks_fn impl = crypto_hashblocks_sha256_select();
+    return impl;
+}
+
+static size_t crypto_hashblocks_sha256(uint32_t *state,
+                                       const uint8_t *in, size_t inlen) {
+    return crypto_hashblocks_sha256_impl()(state, in, inlen);
+}
+
+static const uint32_t iv_256[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+void sha256_inc_init(sha256ctx *state) {
+    for (size_t i = 0; i < 8; ++i) {
+        state->h[i] = iv_256[i];
     }
+    state->bytes = 0;
 }
 
-/* Destroy the hash state. 
+void sha256_inc_ctx_clone(sha256ctx *stateout, const sha256ctx *statein) {
+    *stateout = *statein;
+}
+
+/* The state lives in the caller's sha256ctx; nothing to free. */
 void sha256_inc_ctx_release(sha256ctx *state) {
-    free(state->ctx);
+    (void) state;
 }
-*/
+
 void sha256_inc_blocks(sha256ctx *state, const uint8_t *in, size_t inblocks) {
-    uint64_t bytes = load_bigendian_64(state->ctx + 32);
+    crypto_hashblocks_sha256(state->h, in, 64 * inblocks);
+    state->bytes += 64 * inblocks;
+}
 
-    crypto_hashblocks_sha256(state->ctx, in, 64 * inblocks);
-    bytes += 64 * inblocks;
+/* Write the final (partial) block of a message into padded, followed by
+   the 0x80 terminator and the bit length.  Returns 64 or 128. */
+static size_t sha256_pad(uint8_t padded[128], const uint8_t *in, size_t inlen,
+                         uint64_t bytes) {
+    size_t padlen = (inlen < 56) ? 64 : 128;
 
-    store_bigendian_64(state->ctx + 32, bytes);
+    for (size_t i = 0; i < inlen; ++i) {
+        padded[i] = in[i];
+    }
+    padded[inlen] = 0x80;
+    for (size_t i = inlen + 1; i < padlen - 8; ++i) {
+        padded[i] = 0;
+    }
+    padded[padlen - 8] = (uint8_t) (bytes >> 53);
+    padded[padlen - 7] = (uint8_t) (bytes >> 45);
+    padded[padlen - 6] = (uint8_t) (bytes >> 37);
+    padded[padlen - 5] = (uint8_t) (bytes >> 29);
+    padded[padlen - 4] = (uint8_t) (bytes >> 21);
+    padded[padlen - 3] = (uint8_t) (bytes >> 13);
+    padded[padlen - 2] = (uint8_t) (bytes >> 5);
+    padded[padlen - 1] = (uint8_t) (bytes << 3);
+    return padlen;
 }
 
 void sha256_inc_finalize(uint8_t *out, sha256ctx *state, const uint8_t *in, size_t inlen) {
     uint8_t padded[128];
-    uint64_t bytes = load_bigendian_64(state->ctx + 32) + inlen;
+    uint64_t bytes = state->bytes + inlen;
 
-    crypto_hashblocks_sha256(state->ctx, in, inlen);
+    crypto_hashblocks_sha256(state->h, in, inlen);
     in += inlen;
     inlen &= 63;
     in -= inlen;
 
-    for (size_t i = 0; i < inlen; ++i) {
-        padded[i] = in[i];
+    crypto_hashblocks_sha256(state->h, padded,
+                             sha256_pad(padded, in, inlen, bytes));
+
+    for (size_t i = 0; i < 8; ++i) {
+        store_bigendian_32(out + 4 * i, state->h[i]);
     }
-    padded[inlen] = 0x80;
+}
 
-    if (inlen < 56) {
-        for (size_t i = inlen + 1; i < 56; ++i) {
-            padded[i] = 0;
+void sha256(uint8_t *out, const uint8_t *in, size_t inlen) {
+    sha256ctx state;
+
+    sha256_inc_init(&state);
+    sha256_inc_finalize(out, &state, in, inlen);
+}
+
+/* K[t] + W[t] for the second block of a 64-byte message, which is always
+   0x80, 55 zero bytes and the bit length 512. */
+static const uint32_t sha256_pad64_kw[64] = {
+    0xc28a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf374,
+    0x649b69c1, 0xf0fe4786, 0x0fe1edc6, 0x240cf254,
+    0x4fe9346f, 0x6cc984be, 0x61b9411e, 0x16f988fa,
+    0xf2c65152, 0xa88e5a6d, 0xb019fc65, 0xb9d99ec7,
+    0x9a1231c3, 0xe70eeaa0, 0xfdb1232b, 0xc7353eb0,
+    0x3069bad5, 0xcb976d5f, 0x5a0f118f, 0xdc1eeefd,
+    0x0a35b689, 0xde0b7a04, 0x58f4ca9d, 0xe15d5b16,
+    0x007f3e86, 0x37088980, 0xa507ea32, 0x6fab9537,
+    0x17406110, 0x0d8cd6f1, 0xcdaa3b6d, 0xc0bbbe37,
+    0x83613bda, 0xdb48a363, 0x0b02e931, 0x6fd15ca7,
+    0x521afaca, 0x31338431, 0x6ed41a95, 0x6d437890,
+    0xc39c91f2, 0x9eccabbd, 0xb5c9a0e6, 0x532fb63c,
+    0xd2c741c6, 0x07237ea3, 0xa4954b68, 0x4c191d76
+};
+
+static const uint8_t pad_64[64] = {
+    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0x00
+};
+
+/* Portable two-to-one compression: one data block with the usual schedule,
+   then the padding block with its schedule taken from sha256_pad64_kw. */
+static void sha256_compress2to1_ref(uint8_t *out, const uint8_t *left,
+                                    const uint8_t *right) {
+    uint32_t state[8];
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    uint32_t d;
+    uint32_t e;
+    uint32_t f;
+    uint32_t g;
+    uint32_t h;
+    uint32_t T1;
+    uint32_t T2;
+
+    uint32_t w0  = load_bigendian_32(left + 0);
+    uint32_t w1  = load_bigendian_32(left + 4);
+    uint32_t w2  = load_bigendian_32(left + 8);
+    uint32_t w3  = load_bigendian_32(left + 12);
+    uint32_t w4  = load_bigendian_32(left + 16);
+    uint32_t w5  = load_bigendian_32(left + 20);
+    uint32_t w6  = load_bigendian_32(left + 24);
+    uint32_t w7  = load_bigendian_32(left + 28);
+    uint32_t w8  = load_bigendian_32(right + 0);
+    uint32_t w9  = load_bigendian_32(right + 4);
+    uint32_t w10 = load_bigendian_32(right + 8);
+    uint32_t w11 = load_bigendian_32(right + 12);
+    uint32_t w12 = load_bigendian_32(right + 16);
+    uint32_t w13 = load_bigendian_32(right + 20);
+    uint32_t w14 = load_bigendian_32(right + 24);
+    uint32_t w15 = load_bigendian_32(right + 28);
+
+    for (size_t i = 0; i < 8; ++i) {
+        state[i] = iv_256[i];
+    }
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+    f = state[5];
+    g = state[6];
+    h = state[7];
+
+    ROUNDS_32
+
+    a += state[0];
+    b += state[1];
+    c += state[2];
+    d += state[3];
+    e += state[4];
+    f += state[5];
+    g += state[6];
+    h += state[7];
+
+    state[0] = a;
+    state[1] = b;
+    state[2] = c;
+    state[3] = d;
+    state[4] = e;
+    state[5] = f;
+    state[6] = g;
+    state[7] = h;
+
+    for (size_t t = 0; t < 64; ++t) {
+        F_32(0, sha256_pad64_kw[t])
+    }
+
+    store_bigendian_32(out + 0, a + state[0]);
+    store_bigendian_32(out + 4, b + state[1]);
+    store_bigendian_32(out + 8, c + state[2]);
+    store_bigendian_32(out + 12, d + state[3]);
+    store_bigendian_32(out + 16, e + state[4]);
+    store_bigendian_32(out + 20, f + state[5]);
+    store_bigendian_32(out + 24, g + state[6]);
+    store_bigendian_32(out + 28, h + state[7]);
+}
+
+void sha256_compress2to1(uint8_t *out, const uint8_t *left,
+                         const uint8_t *right) {
+    hashblocks_fn impl = crypto_hashblocks_sha256_impl();
+    uint32_t state[8];
+    uint8_t block[64];
+
+    if (impl == crypto_hashblocks_sha256_ref) {
+        sha256_compress2to1_ref(out, left, right);
+        return;
+    }
+
+    /* The hardware kernels expand the schedule for free; only the
+       padding block is constant. */
+    memcpy(state, iv_256, sizeof(state));
+    memcpy(block, left, 32);
+    memcpy(block + 32, right, 32);
+    impl(state, block, 64);
+    impl(state, pad_64, 64);
+    for (size_t i = 0; i < 8; ++i) {
+        store_bigendian_32(out + 4 * i, state[i]);
+    }
+}
+
+/* ====== Multi-buffer hashing ======
+   Equal-length messages are hashed side by side, one message per vector
+   lane.  The round function is ROUNDS_32 again, with every working
+   variable widened to a vector; the state is word-major, i.e.
+   state[8 * lanes] holds word i of lane l at state[i * lanes + l]. */
+
+#define SHA256_MB_MAX_LANES 16
+
+typedef void (*hashblocks_mb_fn)(uint32_t *state, const uint8_t *const *in,
+                                 size_t nblocks);
+
+#define SHA256_MB_DEFINE(name, vec, load, target)                         \
+target static void name(uint32_t *state, const uint8_t *const *in,        \
+                        size_t nblocks) {                                 \
+    vec s[8], wv[16];                                                     \
+    vec a, b, c, d, e, f, g, h, T1, T2;                                   \
+    vec w0, w1, w2, w3, w4, w5, w6, w7;                                   \
+    vec w8, w9, w10, w11, w12, w13, w14, w15;                             \
+                                                                          \
+    memcpy(s, state, sizeof(s));                                          \
+    for (size_t blk = 0; blk < nblocks; ++blk) {                          \
+        load(wv, in, 64 * blk);                                           \
+        w0 = wv[0];                                                       \
+        w1 = wv[1];                                                       \
+        w2 = wv[2];                                                       \
+        w3 = wv[3];                                                       \
+        w4 = wv[4];                                                       \
+        w5 = wv[5];                                                       \
+        w6 = wv[6];                                                       \
+        w7 = wv[7];                                                       \
+        w8 = wv[8];                                                       \
+        w9 = wv[9];                                                       \
+        w10 = wv[10];                                                     \
+        w11 = wv[11];                                                     \
+        w12 = wv[12];                                                     \
+        w13 = wv[13];                                                     \
+        w14 = wv[14];                                                     \
+        w15 = wv[15];                                                     \
+                                                                          \
+        a = s[0];                                                         \
+        b = s[1];                                                         \
+        c = s[2];                                                         \
+        d = s[3];                                                         \
+        e = s[4];                                                         \
+        f = s[5];                                                         \
+        g = s[6];                                                         \
+        h = s[7];                                                         \
+                                                                          \
+        ROUNDS_32                                                         \
+                                                                          \
+        s[0] += a;                                                        \
+        s[1] += b;                                                        \
+        s[2] += c;                                                        \
+        s[3] += d;                                                        \
+        s[4] += e;                                                        \
+        s[5] += f;                                                        \
+        s[6] += g;                                                        \
+        s[7] += h;                                                        \
+    }                                                                     \
+    memcpy(state, s, sizeof(s));                                          \
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+typedef uint32_t sha256_u32x8 __attribute__((vector_size(32)));
+typedef uint32_t sha256_u32x16 __attribute__((vector_size(64)));
+
+/* Byte-swap every 32-bit word; used where no byte shuffle is available. */
+#define SHA256_MB_BSWAP(x)                                                \
+    ((((x) >> 8 | (x) << 24) & 0xff00ff00) |                              \
+     (((x) << 8 | (x) >> 24) & 0x00ff00ff))
+
+/* Gather the schedule words of 8 lanes (w[t] = W_t of every lane) by
+   loading 32 bytes per lane and transposing 8x8 words in registers. */
+__attribute__((target("avx2")))
+static inline void sha256_mb_load_avx2(sha256_u32x8 w[16],
+                                       const uint8_t *const *in,
+                                       size_t off) {
+    const __m256i bswap = _mm256_set_epi64x(
+        0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+        0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    for (size_t half = 0; half < 2; ++half) {
+        __m256i r[8], t[8], u[8];
+
+        for (size_t l = 0; l < 8; ++l) {
+            r[l] = _mm256_loadu_si256(
+                (const __m256i *) (in[l] + off + 32 * half));
+        }
+        for (size_t l = 0; l < 8; l += 2) {
+            t[l] = _mm256_unpacklo_epi32(r[l], r[l + 1]);
+            t[l + 1] = _mm256_unpackhi_epi32(r[l], r[l + 1]);
+        }
+        /* u[4 * g + m] holds words m, 4 + m of lanes 4g..4g+3 */
+        for (size_t l = 0; l < 8; l += 4) {
+            u[l] = _mm256_unpacklo_epi64(t[l], t[l + 2]);
+            u[l + 1] = _mm256_unpackhi_epi64(t[l], t[l + 2]);
+            u[l + 2] = _mm256_unpacklo_epi64(t[l + 1], t[l + 3]);
+            u[l + 3] = _mm256_unpackhi_epi64(t[l + 1], t[l + 3]);
         }
-        padded[56] = (uint8_t) (bytes >> 53);
-        padded[57] = (uint8_t) (bytes >> 45);
-        padded[58] = (uint8_t) (bytes >> 37);
-        padded[59] = (uint8_t) (bytes >> 29);
-        padded[60] = (uint8_t) (bytes >> 21);
-        padded[61] = (uint8_t) (bytes >> 13);
-        padded[62] = (uint8_t) (bytes >> 5);
-        padded[63] = (uint8_t) (bytes << 3);
-        crypto_hashblocks_sha256(state->ctx, padded, 64);
-    } else {
-        for (size_t i = inlen + 1; i < 120; ++i) {
-            padded[i] = 0;
+        for (size_t m = 0; m < 4; ++m) {
+            w[8 * half + m] = (sha256_u32x8) _mm256_shuffle_epi8(
+                _mm256_permute2x128_si256(u[m], u[m + 4], 0x20), bswap);
+            w[8 * half + m + 4] = (sha256_u32x8) _mm256_shuffle_epi8(
+                _mm256_permute2x128_si256(u[m], u[m + 4], 0x31), bswap);
         }
-        padded[120] = (uint8_t) (bytes >> 53);
-        padded[121] = (uint8_t) (bytes >> 45);
-        padded[122] = (uint8_t) (bytes >> 37);
-        padded[123] = (uint8_t) (bytes >> 29);
-        padded[124] = (uint8_t) (bytes >> 21);
-        padded[125] = (uint8_t) (bytes >> 13);
-        padded[126] = (uint8_t) (bytes >> 5);
-        padded[127] = (uint8_t) (bytes << 3);
-        crypto_hashblocks_sha256(state->ctx, padded, 128);
     }
+}
+
+/* Same for 16 lanes: two unpack stages leave 128-bit chunks of four lanes
+   each, and two 128-bit shuffle stages put those chunks in place. */
+__attribute__((target("avx512f")))
+static inline void sha256_mb_load_avx512(sha256_u32x16 w[16],
+                                         const uint8_t *const *in,
+                                         size_t off) {
+    __m512i r[16], t[16], u[16];
 
-    for (size_t i = 0; i < 32; ++i) {
-        out[i] = state->ctx[i];
+    for (size_t l = 0; l < 16; ++l) {
+        r[l] = _mm512_loadu_si512((const void *) (in[l] + off));
+    }
+    for (size_t l = 0; l < 16; l += 2) {
+        t[l] = _mm512_unpacklo_epi32(r[l], r[l + 1]);
+        t[l + 1] = _mm512_unpackhi_epi32(r[l], r[l + 1]);
+    }
+    /* u[4 * g + m] holds words m, 4 + m, 8 + m, 12 + m of lanes 4g..4g+3 */
+    for (size_t l = 0; l < 16; l += 4) {
+        u[l] = _mm512_unpacklo_epi64(t[l], t[l + 2]);
+        u[l + 1] = _mm512_unpackhi_epi64(t[l], t[l + 2]);
+        u[l + 2] = _mm512_unpacklo_epi64(t[l + 1], t[l + 3]);
+        u[l + 3] = _mm512_unpackhi_epi64(t[l + 1], t[l + 3]);
+    }
+    for (size_t m = 0; m < 4; ++m) {
+        __m512i v0 = _mm512_shuffle_i32x4(u[m], u[4 + m], 0x44);
+        __m512i v1 = _mm512_shuffle_i32x4(u[m], u[4 + m], 0xEE);
+        __m512i v2 = _mm512_shuffle_i32x4(u[8 + m], u[12 + m], 0x44);
+        __m512i v3 = _mm512_shuffle_i32x4(u[8 + m], u[12 + m], 0xEE);
+        sha256_u32x16 x;
+
+        x = (sha256_u32x16) _mm512_shuffle_i32x4(v0, v2, 0x88);
+        w[m] = SHA256_MB_BSWAP(x);
+        x = (sha256_u32x16) _mm512_shuffle_i32x4(v0, v2, 0xDD);
+        w[4 + m] = SHA256_MB_BSWAP(x);
+        x = (sha256_u32x16) _mm512_shuffle_i32x4(v1, v3, 0x88);
+        w[8 + m] = SHA256_MB_BSWAP(x);
+        x = (sha256_u32x16) _mm512_shuffle_i32x4(v1, v3, 0xDD);
+        w[12 + m] = SHA256_MB_BSWAP(x);
     }
-    // sha256_inc_ctx_release(state);
 }
 
-void sha256(uint8_t *out, const uint8_t *in, size_t inlen) {
-    sha256ctx state;
+SHA256_MB_DEFINE(sha256_mb_blocks_avx2, sha256_u32x8, sha256_mb_load_avx2,
+                 __attribute__((target("avx2"))))
+SHA256_MB_DEFINE(sha256_mb_blocks_avx512, sha256_u32x16,
+                 sha256_mb_load_avx512, __attribute__((target("avx512f"))))
+#endif
 
-    sha256_inc_init(&state);
-    sha256_inc_finalize(out, &state, in, inlen);
+#if defined(__wasm_simd128__)
+typedef uint32_t sha256_u32x4 __attribute__((vector_size(16)));
+
+/* Gather the schedule words of 4 lanes with a 4x4 word transpose per
+   16-byte quarter of the block, then byte-swap each word. */
+static inline v128_t sha256_mb_bswap_simd128(v128_t x) {
+    return wasm_i8x16_shuffle(x, x, 3, 2, 1, 0, 7, 6, 5, 4,
+                              11, 10, 9, 8, 15, 14, 13, 12);
+}
+
+static inline void sha256_mb_load_simd128(sha256_u32x4 w[16],
+                                          const uint8_t *const *in,
+                                          size_t off) {
+    for (size_t q = 0; q < 4; ++q) {
+        v128_t r0 = wasm_v128_load(in[0] + off + 16 * q);
+        v128_t r1 = wasm_v128_load(in[1] + off + 16 * q);
+        v128_t r2 = wasm_v128_load(in[2] + off + 16 * q);
+        v128_t r3 = wasm_v128_load(in[3] + off + 16 * q);
+        v128_t t0 = wasm_i32x4_shuffle(r0, r1, 0, 4, 1, 5);
+        v128_t t1 = wasm_i32x4_shuffle(r0, r1, 2, 6, 3, 7);
+        v128_t t2 = wasm_i32x4_shuffle(r2, r3, 0, 4, 1, 5);
+        v128_t t3 = wasm_i32x4_shuffle(r2, r3, 2, 6, 3, 7);
+
+        w[4 * q + 0] = (sha256_u32x4) sha256_mb_bswap_simd128(
+            wasm_i64x2_shuffle(t0, t2, 0, 2));
+        w[4 * q + 1] = (sha256_u32x4) sha256_mb_bswap_simd128(
+            wasm_i64x2_shuffle(t0, t2, 1, 3));
+        w[4 * q + 2] = (sha256_u32x4) sha256_mb_bswap_simd128(
+            wasm_i64x2_shuffle(t1, t3, 0, 2));
+        w[4 * q + 3] = (sha256_u32x4) sha256_mb_bswap_simd128(
+            wasm_i64x2_shuffle(t1, t3, 1, 3));
+    }
+}
+
+SHA256_MB_DEFINE(sha256_mb_blocks_simd128, sha256_u32x4,
+                 sha256_mb_load_simd128, )
+#endif
+
+/* Hash lanes messages of len bytes with one lane-parallel block function. */
+static void sha256_mb_group(uint8_t out[][32], const uint8_t *const in[],
+                            size_t len, size_t lanes,
+                            hashblocks_mb_fn blocks) {
+    uint32_t state[8 * SHA256_MB_MAX_LANES];
+    uint8_t padded[SHA256_MB_MAX_LANES][128];
+    const uint8_t *tail[SHA256_MB_MAX_LANES];
+    size_t full = len / 64;
+    size_t padlen = 64;
+
+    for (size_t i = 0; i < 8; ++i) {
+        for (size_t l = 0; l < lanes; ++l) {
+            state[i * lanes + l] = iv_256[i];
+        }
+    }
+
+    blocks(state, in, full);
+
+    for (size_t l = 0; l < lanes; ++l) {
+        padlen = sha256_pad(padded[l], in[l] + 64 * full, len & 63, len);
+        tail[l] = padded[l];
+    }
+    blocks(state, tail, padlen / 64);
+
+    for (size_t l = 0; l < lanes; ++l) {
+        for (size_t i = 0; i < 8; ++i) {
+            store_bigendian_32(out[l] + 4 * i, state[i * lanes + l]);
+        }
+    }
+}
+
+struct sha256_mb_impl {
+    size_t lanes;
+    hashblocks_mb_fn blocks;
+};
+
+/* Eight AVX2 lanes only match one SHA-NI stream, so on cores with the SHA
+   extensions multi-buffer hashing is used only when AVX-512 is present. */
+static struct sha256_mb_impl sha256_mb_select(void) {
+    struct sha256_mb_impl impl = { 1, NULL };
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has(CPU_FEATURE_AVX512F)) {
+        impl.lanes = 16;
+        impl.blocks = sha256_mb_blocks_avx512;
+    } else if (cpu_has(CPU_FEATURE_AVX2) && !cpu_has(CPU_FEATURE_SHA)) {
+        impl.lanes = 8;
+        impl.blocks = sha256_mb_blocks_avx2;
+    }
+#elif defined(__wasm_simd128__)
+    impl.lanes = 4;
+    impl.blocks = sha256_mb_blocks_simd128;
+#endif
+    return impl;
+}
+
+void sha256_many(uint8_t out[][32], const uint8_t *const in[], size_t len,
+                 size_t n) {
+    static const struct sha256_mb_impl impl = sha256_mb_select();
+    size_t i = 0;
+
+    if (impl.blocks != NULL) {
+        for (; i + impl.lanes <= n; i += impl.lanes) {
+            sha256_mb_group(out + i, in + i, len, impl.lanes, impl.blocks);
+        }
+    }
+    for (; i < n; ++i) {
+        sha256(out[i], in[i], len);
+    }
 }
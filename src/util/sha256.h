@@ -8,9 +8,12 @@
     must be exactly 64 bytes each.
     Use the 'finalize' functions for any remaining bytes (possibly over 64). */
 
-/* Structure for the incremental API */
+/* Structure for the incremental API.  The chaining value is kept in native
+   word order and converted to big-endian bytes only when the digest is
+   produced; the context is a plain value and may be copied freely. */
 typedef struct {
-    uint8_t *ctx;
+    uint32_t h[8];
+    uint64_t bytes;
 } sha256ctx;
 
 /* ====== SHA256 API ==== */
@@ -32,13 +35,12 @@ void sha256_inc_blocks(sha256ctx *state, const uint8_t *in, size_t inblocks);
 
 /**
  * Finalize and obtain the digest
- *
- * If applicable, this function will free the memory associated with the sha256ctx.
  */
 void sha256_inc_finalize(uint8_t *out, sha256ctx *state, const uint8_t *in, size_t inlen);
 
 /**
- * Destroy the state. Make sure to use this, as this API may not always be stack-based.
+ * Destroy the state. The context holds no heap memory, so this is a no-op
+ * kept for API compatibility.
  */
 void sha256_inc_ctx_release(sha256ctx *state);
 
@@ -47,4 +49,24 @@ void sha256_inc_ctx_release(sha256ctx *state);
  */
 void sha256(uint8_t *out, const uint8_t *in, size_t inlen);
 
+/**
+ * Merkle-node hash: out = sha256(left || right) for two 32-byte digests.
+ *
+ * Equivalent to sha256() on the 64-byte concatenation, but skips the
+ * generic padding logic; the schedule of the constant second block is
+ * precomputed.
+ */
+void sha256_compress2to1(uint8_t *out, const uint8_t *left,
+                         const uint8_t *right);
+
+/**
+ * Hash n independent messages of inlen bytes each: out[i] = sha256(in[i]).
+ *
+ * Messages are processed 16 (AVX-512), 8 (AVX2) or 4 (wasm SIMD128) at a
+ * time in vector lanes when that beats hashing them one by one; leftovers
+ * and other CPUs use the one-message path.
+ */
+void sha256_many(uint8_t out[][32], const uint8_t *const in[], size_t inlen,
+                 size_t n);
+
 #endif
@@ -0,0 +1,194 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "util/trace.h"
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace proofs {
+
+namespace {
+
+constexpr size_t kRingEvents = 1 << 16;
+
+struct TraceEvent {
+  const char* name;
+  uint64_t start_ns;
+  uint64_t dur_ns;
+};
+
+// One per thread that is recording spans.  Buffers are linked into a
+// global lock-free list and never freed, so a dump can still read the
+// events of threads that have exited.  When its thread exits, a buffer
+// becomes free for a new thread as soon as every event in it has been
+// dumped (or reset), so the list grows with the number of threads alive
+// at once rather than with the number ever created.
+struct ThreadBuffer {
+  TraceEvent events[kRingEvents];
+  std::atomic<uint64_t> head{0};    // total events written
+  std::atomic<uint64_t> dumped{0};  // head as of the last dump or reset
+  std::atomic<bool> live{true};     // owned by a running thread
+  uint32_t tid;
+  ThreadBuffer* next;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<ThreadBuffer*> g_buffers{nullptr};
+std::atomic<uint32_t> g_next_tid{1};
+const auto g_epoch = std::chrono::steady_clock::now();
+
+uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - g_epoch)
+      .count();
+}
+
+// Claims a buffer whose thread has exited and whose events have all been
+// dumped, or returns null.
+ThreadBuffer* reuse_buffer() {
+  for (ThreadBuffer* tb = g_buffers.load(std::memory_order_acquire);
+       tb != nullptr; tb = tb->next) {
+    if (tb->live.load(std::memory_order_relaxed) ||
+        tb->dumped.load(std::memory_order_relaxed) !=
+            tb->head.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    bool expected = false;
+    if (tb->live.compare_exchange_strong(expected, true,
+                                         std::memory_order_acquire)) {
+      tb->head.store(0, std::memory_order_relaxed);
+      tb->dumped.store(0, std::memory_order_relaxed);
+      return tb;
+    }
+  }
+  return nullptr;
+}
+
+// Hands the thread's buffer back when the thread exits.
+struct BufferOwner {
+  ThreadBuffer* tb = nullptr;
+  ~BufferOwner() {
+    if (tb != nullptr) tb->live.store(false, std::memory_order_release);
+  }
+};
+
+ThreadBuffer* thread_buffer() {
+  static thread_local BufferOwner owner;
+  ThreadBuffer* tb = owner.tb;
+  if (tb == nullptr) {
+    tb = reuse_buffer();
+    if (tb == nullptr) {
+      tb = new ThreadBuffer;
+      tb->next = g_buffers.load(std::memory_order_relaxed);
+      while (!g_buffers.compare_exchange_weak(tb->next, tb,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+      }
+    }
+    tb->tid = g_next_tid.fetch_add(1, std::memory_order_relaxed);
+    owner.tb = tb;
+  }
+  return tb;
+}
+
+void write_json_string(FILE* f, const char* s) {
+  fputc('"', f);
+  for (; *s; ++s) {
+    unsigned char c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\') {
+      fputc('\\', f);
+      fputc(c, f);
+    } else if (c < 0x20) {
+      fprintf(f, "\\u%04x", c);
+    } else {
+      fputc(c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+}  // namespace
+
+void trace_enable(bool on) { g_enabled.store(on, std::memory_order_relaxed); }
+
+bool trace_enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+TraceSpan::TraceSpan(const char* name) : name_(nullptr), start_ns_(0) {
+  if (trace_enabled()) {
+    name_ = name;
+    start_ns_ = now_ns();
+  }
+}
+
+TraceSpan::~TraceSpan() {
+  if (name_ == nullptr) return;
+  uint64_t end_ns = now_ns();
+  ThreadBuffer* tb = thread_buffer();
+  uint64_t h = tb->head.load(std::memory_order_relaxed);
+  TraceEvent& e = tb->events[h % kRingEvents];
+  e.name = name_;
+  e.start_ns = start_ns_;
+  e.dur_ns = end_ns - start_ns_;
+  tb->head.store(h + 1, std::memory_order_release);
+}
+
+bool trace_dump_json(const char* path) {
+  FILE* f = fopen(path, "w");
+  if (f == nullptr) return false;
+
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  for (ThreadBuffer* tb = g_buffers.load(std::memory_order_acquire);
+       tb != nullptr; tb = tb->next) {
+    uint64_t h = tb->head.load(std::memory_order_acquire);
+    uint64_t begin = h > kRingEvents ? h - kRingEvents : 0;
+    for (uint64_t i = begin; i < h; ++i) {
+      const TraceEvent& e = tb->events[i % kRingEvents];
+      fprintf(f, "%s\n{\"name\":", first ? "" : ",");
+      write_json_string(f, e.name);
+      fprintf(f,
+              ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03llu,"
+              "\"dur\":%llu.%03llu}",
+              tb->tid, static_cast<unsigned long long>(e.start_ns / 1000),
+              static_cast<unsigned long long>(e.start_ns % 1000),
+              static_cast<unsigned long long>(e.dur_ns / 1000),
+              static_cast<unsigned long long>(e.dur_ns % 1000));
+      first = false;
+    }
+    tb->dumped.store(h, std::memory_order_relaxed);
+  }
+  fprintf(f, "\n]}\n");
+  return fclose(f) == 0;
+}
+
+void trace_reset() {
+  for (ThreadBuffer* tb = g_buffers.load(std::memory_order_acquire);
+       tb != nullptr; tb = tb->next) {
+    tb->head.store(0, std::memory_order_release);
+    tb->dumped.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace proofs
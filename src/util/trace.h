@@ -0,0 +1,75 @@
+/* This file is part of Zenroom (https://zenroom.dyne.org)
+ *
+ * Copyright (C) 2025 Dyne.org foundation
+ * designed, written and maintained by Denis Roio <jaromil@dyne.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRIVACY_PROOFS_ZK_LIB_UTIL_TRACE_H_
+#define PRIVACY_PROOFS_ZK_LIB_UTIL_TRACE_H_
+
+// Scoped phase tracer.  A TraceSpan records the wall time between its
+// construction and destruction into a per-thread ring buffer; the
+// buffers can be dumped as Chrome trace-event JSON, which loads in
+// chrome://tracing and ui.perfetto.dev.  Spans nest naturally: the
+// viewers stack complete events of the same thread by time.
+//
+// Tracing is off by default and a disabled span costs one relaxed load.
+// Recording never locks; each thread only writes its own buffer, and the
+// oldest events are overwritten once a buffer is full.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace proofs {
+
+void trace_enable(bool on);
+bool trace_enabled();
+
+class TraceSpan {
+ public:
+  // NAME must outlive the trace (normally a string literal).
+  explicit TraceSpan(const char* name);
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_ns_;
+};
+
+// Writes every recorded event to PATH in Chrome trace-event JSON format.
+// Call it once the traced work is done; events recorded concurrently with
+// the dump may be missed.  Returns false if the file cannot be written.
+// Once dumped, the buffers of threads that have exited are reused by new
+// threads, so their events may be absent from later dumps.
+bool trace_dump_json(const char* path);
+
+// Discards all recorded events.  Same caveat as trace_dump_json().
+void trace_reset();
+
+}  // namespace proofs
+
+#define PROOFS_TRACE_CONCAT_(a, b) a##b
+#define PROOFS_TRACE_CONCAT(a, b) PROOFS_TRACE_CONCAT_(a, b)
+
+// Traces the rest of the enclosing scope under NAME.
+#define PROOFS_TRACE_SCOPE(name) \
+  ::proofs::TraceSpan PROOFS_TRACE_CONCAT(proofs_trace_span_, __LINE__)(name)
+
+#endif  // PRIVACY_PROOFS_ZK_LIB_UTIL_TRACE_H_